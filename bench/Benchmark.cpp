@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include "../src/Auxiliar.h"
+#include "../src/Management.h"
+#include "../src/NetworkGenerator.h"
+
+/**
+ * @brief One Management query to time
+ */
+struct BenchQuery {
+    std::string name;
+    bool needsBaseline; // the baseline max flow is computed before timing, as a failure analysis would find it
+    std::function<void(Management &)> run;
+};
+
+/**
+ * @brief One network to run the queries on
+ */
+struct BenchNetwork {
+    std::string name;
+    std::function<void(Graph *)> load;
+};
+
+/**
+ * @brief Gets the first ServicePoint of a kind in the Graph
+ * @param g
+ * @return ServicePoint, nullptr if there is none
+ */
+template <typename T>
+static ServicePoint * firstOf(Graph *g) {
+    for (ServicePoint *v : g->getServicePointSet()) {
+        if (dynamic_cast<T *>(v) != nullptr)
+            return v;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Splits a comma separated list of numbers
+ * @param list
+ * @return numbers
+ */
+static std::vector<long> parseList(const std::string &list) {
+    std::vector<long> numbers;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        numbers.push_back(std::atol(item.c_str()));
+    return numbers;
+}
+
+/**
+ * Times every Management query on the bundled datasets and on generated networks, with every max flow algorithm.
+ *
+ * Options:
+ *  --repeat <n>        runs of each query, the median time is reported (default 3)
+ *  --algorithm <name>  only run edmonds-karp, dinic or push-relabel
+ *  --pipes <n,...>     Pipe rows of each generated network (default 2000,10000), 0 for none
+ *  --seed <n>          seed of the generated networks (default 1)
+ *  --no-datasets       skip the bundled datasets
+ *
+ * Each query runs on a fresh Management, with the scenario cache off. The failure analyses and the crucial Pipes
+ * start from a computed baseline, which is not timed. The output is CSV with one row per network, algorithm and
+ * query, always in the same order: "network,pipes,algorithm,query,time_ms,augmentations,peak_rss_kb". The
+ * augmentations are the augmenting paths and pushes of one run, and the peak RSS is the one of the process after the
+ * query. Run it from the build directory, as the datasets are read from ../data.
+ */
+int main(int argc, char *argv[]) {
+    int repeat = 3;
+    std::string onlyAlgorithm;
+    std::vector<long> generatedPipes = {2000, 10000};
+    uint32_t seed = 1;
+    bool datasets = true;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--no-datasets") == 0)
+            datasets = false;
+        else if (i + 1 >= argc)
+            break;
+        else if (std::strcmp(argv[i], "--repeat") == 0)
+            repeat = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--algorithm") == 0)
+            onlyAlgorithm = argv[++i];
+        else if (std::strcmp(argv[i], "--pipes") == 0)
+            generatedPipes = parseList(argv[++i]);
+        else if (std::strcmp(argv[i], "--seed") == 0)
+            seed = (uint32_t) std::atol(argv[++i]);
+    }
+
+    std::vector<BenchNetwork> networks;
+    if (datasets) {
+        networks.push_back({"small", [](Graph *g) { Auxiliar::readDataset(g, 0); }});
+        networks.push_back({"large", [](Graph *g) { Auxiliar::readDataset(g, 1); }});
+    }
+    for (long pipes : generatedPipes) {
+        if (pipes <= 0)
+            continue;
+        GeneratorOptions options;
+        options.pipes = pipes;
+        options.stations = (int) std::max(1L, pipes / 5);
+        options.cities = (int) std::max(1L, pipes / 25);
+        options.reservoirs = (int) std::max(1L, pipes / 200);
+        options.pipes = std::max(pipes, (long) options.stations + options.cities);
+        options.seed = seed;
+        networks.push_back({"generated-" + std::to_string(pipes), [options](Graph *g) {
+            NetworkGenerator(options).build(g);
+        }});
+    }
+
+    std::vector<std::pair<std::string, FlowAlgorithm>> algorithms = {
+            {"edmonds-karp", FlowAlgorithm::EDMONDS_KARP},
+            {"dinic", FlowAlgorithm::DINIC},
+            {"push-relabel", FlowAlgorithm::PUSH_RELABEL}};
+
+    std::cout << "network,pipes,algorithm,query,time_ms,augmentations,peak_rss_kb\n";
+    for (const BenchNetwork &network : networks) {
+        Graph g;
+        network.load(&g);
+        ServicePoint *city = firstOf<City>(&g);
+        ServicePoint *reservoir = firstOf<Reservoir>(&g);
+        ServicePoint *station = firstOf<Station>(&g);
+        Pipe *pipe = g.getPipeSet().empty() ? nullptr : g.getPipeSet()[0];
+
+        std::vector<BenchQuery> queries = {
+                {"maxflow", false, [](Management &m) { m.getMaxFlow(); }},
+                {"city", false, [city](Management &m) { m.getMaxFlowCity(city); }},
+                {"deficit", false, [](Management &m) { m.getFlowDeficit(); }},
+                {"balance", false, [](Management &m) { m.getMaxFlowBalance(); }},
+                {"reservoir", true, [reservoir](Management &m) { m.getCitiesAffectedByReservoirFail(reservoir); }},
+                {"station", true, [station](Management &m) { m.getCitiesAffectedByStationFail(station); }},
+                {"pipe", true, [pipe](Management &m) { m.getCitiesAffectedByPipeRupture(pipe); }},
+                {"contingencies", true, [](Management &m) { m.getContingencies(); }},
+                {"crucial", true, [city](Management &m) { m.getCrucialPipesToCity(city); }}};
+
+        for (const auto &algorithm : algorithms) {
+            if (!onlyAlgorithm.empty() && algorithm.first != onlyAlgorithm)
+                continue;
+            for (const BenchQuery &query : queries) {
+                std::vector<double> times;
+                unsigned long augmentations = 0;
+                for (int run = 0; run < repeat; run++) {
+                    Management m(&g);
+                    m.setAlgorithm(algorithm.second);
+                    m.getScenarioCache().setCapacity(0);
+                    if (query.needsBaseline)
+                        m.ensureBaseline();
+                    unsigned long before = m.getAugmentations();
+                    auto start = std::chrono::steady_clock::now();
+                    query.run(m);
+                    auto end = std::chrono::steady_clock::now();
+                    times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+                    augmentations = m.getAugmentations() - before;
+                }
+                std::sort(times.begin(), times.end());
+                std::cout << network.name << ',' << g.getPipeSet().size() << ',' << algorithm.first << ','
+                          << query.name << ',' << std::fixed << std::setprecision(3) << times[times.size() / 2] << ','
+                          << augmentations << ',' << MemoryReport::getPeakRssKb() << std::endl;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,499 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include "../src/Management.h"
+#include "../src/NetworkGenerator.h"
+
+/**
+ * @brief One network to compare the engines on
+ */
+struct DiffNetwork {
+    std::string name;
+    std::function<void(Graph *)> load;
+};
+
+/**
+ * @brief Outcome of one engine on one network
+ */
+struct EngineRun {
+    double timeMs = 0;
+    double total = 0;
+    std::unordered_map<std::string,int> flowPerCity;
+    std::string error; // empty if the flow is a valid max flow
+};
+
+static const double EPSILON = 1e-6;
+
+// Codes of the i-th Reservoir, Station and City, numbered from 1 as in the datasets
+static std::string reservoir(int i) { return "R_" + std::to_string(i); }
+static std::string station(int i) { return "PS_" + std::to_string(i); }
+static std::string city(int i) { return "C_" + std::to_string(i); }
+
+/**
+ * @brief Adds the i-th Reservoir
+ * @param g
+ * @param i
+ * @param maxDelivery
+ */
+static void addReservoir(Graph *g, int i, int maxDelivery) {
+    g->addReservoir(new Reservoir("Reservoir " + std::to_string(i), "Municipality", std::to_string(i), reservoir(i),
+                                  maxDelivery));
+}
+
+/**
+ * @brief Adds the i-th Station
+ * @param g
+ * @param i
+ */
+static void addStation(Graph *g, int i) {
+    g->addStation(new Station(std::to_string(i), station(i)));
+}
+
+/**
+ * @brief Adds the i-th City
+ * @param g
+ * @param i
+ * @param demand
+ */
+static void addCity(Graph *g, int i, int demand) {
+    g->addCity(new City("City " + std::to_string(i), std::to_string(i), city(i), demand, demand * 150));
+}
+
+/**
+ * @brief Two rails of Stations joined by bidirectional rungs of capacity 1, which lure path-based engines into many
+ * tiny augmentations across the rungs
+ * @param g
+ * @param n Stations per rail
+ */
+static void buildLadder(Graph *g, int n) {
+    addReservoir(g, 1, 1000);
+    addReservoir(g, 2, 1000);
+    for (int i = 1; i <= 2 * n; i++)
+        addStation(g, i);
+    addCity(g, 1, 900);
+    addCity(g, 2, 900);
+    g->addPipe(reservoir(1), station(1), 1000);
+    g->addPipe(reservoir(2), station(n + 1), 1000);
+    for (int i = 1; i <= n; i++) {
+        if (i < n) {
+            g->addPipe(station(i), station(i + 1), 1000 - i % 7);
+            g->addPipe(station(n + i), station(n + i + 1), 1000 - i % 5);
+        }
+        g->addBidirectionalPipe(station(i), station(n + i), 1);
+    }
+    g->addPipe(station(n), city(1), 1000);
+    g->addPipe(station(2 * n), city(2), 1000);
+    g->addPipe(station(n), city(2), 1);
+}
+
+/**
+ * @brief One long path of Stations with a City hanging off every tenth one, which makes every search go deep
+ * @param g
+ * @param n Stations
+ */
+static void buildChain(Graph *g, int n) {
+    addReservoir(g, 1, 100000);
+    for (int i = 1; i <= n; i++)
+        addStation(g, i);
+    g->addPipe(reservoir(1), station(1), 100000);
+    int cities = 0;
+    for (int i = 1; i < n; i++) {
+        g->addPipe(station(i), station(i + 1), 50000 - 10 * i);
+        if (i % 10 == 0) {
+            cities++;
+            addCity(g, cities, 30 + i % 70);
+            g->addPipe(station(i), city(cities), 20 + i % 90);
+        }
+    }
+}
+
+/**
+ * @brief Every Reservoir feeds every Station and every Station feeds every City with the same capacity, so there are
+ * many shortest paths of the same length and the engines break ties differently
+ * @param g
+ * @param n Reservoirs, Stations and Cities of each layer
+ */
+static void buildTies(Graph *g, int n) {
+    for (int i = 1; i <= n; i++) {
+        addReservoir(g, i, 100);
+        addStation(g, i);
+        addCity(g, i, 100);
+    }
+    for (int i = 1; i <= n; i++) {
+        for (int j = 1; j <= n; j++) {
+            g->addPipe(reservoir(i), station(j), 10);
+            g->addPipe(station(i), city(j), 10);
+        }
+    }
+}
+
+/**
+ * @brief A ring of bidirectional Pipes with Reservoirs and Cities around it, so flow can go either way round
+ * @param g
+ * @param n Stations in the ring
+ */
+static void buildRing(Graph *g, int n) {
+    for (int i = 1; i <= n; i++)
+        addStation(g, i);
+    for (int i = 1; i <= n; i++)
+        g->addBidirectionalPipe(station(i), station(i % n + 1), 50 + (i * 37) % 200);
+    for (int i = 1; i <= n / 4; i++) {
+        addReservoir(g, i, 300 + (i * 53) % 400);
+        g->addPipe(reservoir(i), station(4 * i - 3), 500);
+        addCity(g, i, 200 + (i * 71) % 300);
+        g->addPipe(station(4 * i - 1), city(i), 400);
+    }
+}
+
+/**
+ * @brief Degenerate elements: a Reservoir that delivers nothing, Cities that no Pipe reaches or that want nothing,
+ * zero capacity Pipes, an island of Stations and a single Station every other path goes through
+ * @param g
+ * @param n Reservoirs and Cities on each side of the bottleneck
+ */
+static void buildDegenerate(Graph *g, int n) {
+    for (int i = 1; i <= n; i++)
+        addReservoir(g, i, i == 1 ? 0 : 100 * i);
+    for (int i = 1; i <= 4; i++)
+        addStation(g, i);
+    for (int i = 1; i <= n + 2; i++)
+        addCity(g, i, i == n + 2 ? 0 : 50 + 10 * i);
+    for (int i = 1; i <= n; i++)
+        g->addPipe(reservoir(i), station(1), 80 * i);
+    g->addPipe(station(1), station(2), 50 * n);
+    for (int i = 1; i <= n; i++)
+        g->addPipe(station(2), city(i), i % 3 == 0 ? 0 : 60 * i);
+    g->addBidirectionalPipe(station(3), station(4), 100);
+    g->addPipe(station(3), city(n + 2), 100);
+}
+
+/**
+ * @brief Checks that a flow respects the capacities and the conservation on every ServicePoint, and that no
+ * augmenting path is left in the residual network, which makes it a max flow without trusting any engine
+ * @param r
+ * @param state
+ * @return error, empty if the flow is a valid max flow
+ * @details Time Complexity O(S+P), S = number of ServicePoints, P = number of Pipes
+ */
+static std::string checkFlow(const ResidualGraph &r, const FlowState &state) {
+    int s = r.getSuperSource();
+    int t = r.getSuperSink();
+    std::vector<double> balance(r.getServicePointCount(), 0);
+    for (int p : r.getPipes()) {
+        double flow = state.getFlow(p);
+        if (flow < -EPSILON || flow > r.getCapacity(p) + EPSILON)
+            return "pipe " + std::to_string(p) + " carries " + std::to_string(flow) + " over its capacity";
+        int a = r.getForwardArc(p);
+        balance[r.getTail(a)] -= flow;
+        balance[r.getArc(a).head] += flow;
+    }
+    for (int v : r.getServicePoints()) {
+        if (v != s && v != t && std::fabs(balance[v]) > EPSILON)
+            return "service point " + std::to_string(v) + " does not conserve flow";
+    }
+
+    std::vector<char> reached(r.getServicePointCount(), 0);
+    std::vector<int> queue = {s};
+    reached[s] = 1;
+    for (size_t i = 0; i < queue.size(); i++) {
+        int v = queue[i];
+        for (int a = r.getArcBegin(v); a < r.getArcEnd(v); a++) {
+            const ResidualArc &arc = r.getArc(a);
+            double flow = state.getFlow(arc.pipe);
+            double residual = arc.forward ? r.getCapacity(arc.pipe) - flow : flow;
+            if (residual > EPSILON && !reached[arc.head]) {
+                reached[arc.head] = 1;
+                queue.push_back(arc.head);
+            }
+        }
+    }
+    if (reached[t])
+        return "an augmenting path is left";
+    return "";
+}
+
+/**
+ * @brief Runs one engine on a network, keeping the median time
+ * @param g
+ * @param algorithm
+ * @param repeat
+ * @return outcome of the last run
+ */
+static EngineRun runEngine(Graph *g, FlowAlgorithm algorithm, int repeat) {
+    Management m(g);
+    m.setAlgorithm(algorithm);
+    const ResidualGraph &r = m.getResidualGraph();
+    std::vector<double> times;
+    EngineRun run;
+    for (int i = 0; i < repeat; i++) {
+        FlowState state(r);
+        auto start = std::chrono::steady_clock::now();
+        m.maxFlow(state, r, r.getSuperSource(), r.getSuperSink());
+        auto end = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        if (i + 1 < repeat)
+            continue;
+        run.error = checkFlow(r, state);
+        m.spreadOverCities(state, r);
+        if (run.error.empty())
+            run.error = checkFlow(r, state);
+        run.flowPerCity = m.getFlowPerCity(state);
+        int t = r.getSuperSink();
+        for (int a = r.getArcBegin(t); a < r.getArcEnd(t); a++)
+            run.total += state.getFlow(r.getArc(a).pipe);
+    }
+    std::sort(times.begin(), times.end());
+    run.timeMs = times[times.size() / 2];
+    return run;
+}
+
+/**
+ * @brief Counts the Cities whose flow differs between two runs
+ * @param a
+ * @param b
+ * @return count
+ */
+static int countDiffering(const std::unordered_map<std::string,int> &a, const std::unordered_map<std::string,int> &b) {
+    int count = 0;
+    for (const auto &entry : a) {
+        auto it = b.find(entry.first);
+        if (it == b.end() || it->second != entry.second)
+            count++;
+    }
+    return count + (int) (b.size() > a.size() ? b.size() - a.size() : 0);
+}
+
+/**
+ * @brief Sums the flow of every City
+ * @param flowPerCity
+ * @return total
+ */
+static long sumFlow(const std::unordered_map<std::string,int> &flowPerCity) {
+    long total = 0;
+    for (const auto &entry : flowPerCity)
+        total += entry.second;
+    return total;
+}
+
+/**
+ * @brief Gets the crucial Pipes to a City, with their new flow, in a canonical order
+ * @param m
+ * @param city
+ * @return index of each crucial Pipe and the new flow of the City without it, sorted
+ */
+static std::vector<std::pair<int,int>> getCrucialSet(Management &m, ServicePoint *city) {
+    std::vector<std::pair<int,int>> crucial;
+    for (const std::pair<Pipe *, flowDiff> &entry : m.getCrucialPipesToCity(city))
+        crucial.emplace_back(entry.first->getIndex(), entry.second.newFlow);
+    std::sort(crucial.begin(), crucial.end());
+    return crucial;
+}
+
+/**
+ * @brief Counts the failures of two contingency sweeps whose affected Cities or flows differ
+ * @param a
+ * @param b
+ * @return count
+ */
+static int countDifferingFailures(const std::vector<contingency> &a, const std::vector<contingency> &b) {
+    int count = (int) (a.size() > b.size() ? a.size() - b.size() : b.size() - a.size());
+    for (std::size_t i = 0; i < std::min(a.size(), b.size()); i++) {
+        const std::vector<std::pair<std::string, flowDiff>> &x = a[i].citiesAffected, &y = b[i].citiesAffected;
+        bool same = a[i].servicePoint == b[i].servicePoint && a[i].pipe == b[i].pipe && x.size() == y.size();
+        for (std::size_t j = 0; same && j < x.size(); j++)
+            same = x[j].first == y[j].first && x[j].second.oldFlow == y[j].second.oldFlow
+                    && x[j].second.newFlow == y[j].second.newFlow;
+        count += !same;
+    }
+    return count;
+}
+
+/**
+ * Generates random and adversarial networks, runs every max flow engine on each of them and checks that they agree.
+ *
+ * Options:
+ *  --networks <n>   random networks (default 30)
+ *  --max-pipes <n>  largest random network, in Pipe rows (default 5000)
+ *  --failures <n>   random failures repaired incrementally on each network (default 5)
+ *  --repeat <n>     runs of each engine, the median time is reported (default 3)
+ *  --crucial <n>    random Cities whose crucial Pipes are found in both modes on each network (default 1)
+ *  --crucial-max-pipes <n>
+ *                   largest network of the crucial Pipes check, in Pipe rows, as it solves once per Pipe (default 1000)
+ *  --contingencies-max-pipes <n>
+ *                   largest network whose contingencies are swept in both modes, in Pipe rows (default 1000)
+ *  --seed <n>       seed of the random networks and failures (default 1)
+ *
+ * Every flow must respect the capacities and the conservation, and leave no augmenting path. Every engine must reach
+ * the total of Edmonds-Karp and, once its flow is spread over the Cities as Management does, give every City the flow
+ * it gets with Edmonds-Karp. The time covers the engine only. The incremental repair of a failure must give every City
+ * the flow of a full solve of the same failure, and the crucial Pipes to a City and the Cities affected by every
+ * failure of the contingency sweep must be the same in both modes.
+ *
+ * The output is CSV with one row per network and engine: "network,pipes,engine,time_ms,ratio,total,cities_differing,
+ * status". The ratio is the time over the Edmonds-Karp time, or over the full solve for the repair, crucial and
+ * contingencies rows, and the status is "ok" or what failed. The exit code is 1 if any check failed.
+ */
+int main(int argc, char *argv[]) {
+    int networkCount = 30;
+    long maxPipes = 5000;
+    int failures = 5;
+    int repeat = 3;
+    int crucialCities = 1;
+    long crucialMaxPipes = 1000;
+    long contingenciesMaxPipes = 1000;
+    uint32_t seed = 1;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (std::strcmp(argv[i], "--networks") == 0)
+            networkCount = std::max(0, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--max-pipes") == 0)
+            maxPipes = std::max(50L, std::atol(argv[++i]));
+        else if (std::strcmp(argv[i], "--failures") == 0)
+            failures = std::max(0, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--repeat") == 0)
+            repeat = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--crucial") == 0)
+            crucialCities = std::max(0, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--crucial-max-pipes") == 0)
+            crucialMaxPipes = std::atol(argv[++i]);
+        else if (std::strcmp(argv[i], "--contingencies-max-pipes") == 0)
+            contingenciesMaxPipes = std::atol(argv[++i]);
+        else if (std::strcmp(argv[i], "--seed") == 0)
+            seed = (uint32_t) std::atol(argv[++i]);
+    }
+
+    std::vector<DiffNetwork> networks = {
+            {"ladder", [](Graph *g) { buildLadder(g, 300); }},
+            {"chain", [](Graph *g) { buildChain(g, 3000); }},
+            {"ties", [](Graph *g) { buildTies(g, 40); }},
+            {"ring", [](Graph *g) { buildRing(g, 400); }},
+            {"degenerate", [](Graph *g) { buildDegenerate(g, 12); }}};
+    std::mt19937 rng(seed);
+    for (int i = 0; i < networkCount; i++) {
+        GeneratorOptions options;
+        long pipes = 50 + (long) (rng() % (uint32_t) (maxPipes - 49));
+        options.stations = (int) std::max(1L, pipes / (3 + (long) (rng() % 5)));
+        options.cities = (int) std::max(1L, pipes / (10 + (long) (rng() % 30)));
+        options.reservoirs = (int) std::max(1L, pipes / (50 + (long) (rng() % 200)));
+        options.pipes = std::max(pipes, (long) options.stations + options.cities);
+        options.bidirectionalShare = (double) (rng() % 101) / 100;
+        options.seed = rng();
+        networks.push_back({"random-" + std::to_string(i + 1), [options](Graph *g) {
+            NetworkGenerator(options).build(g);
+        }});
+    }
+
+    std::vector<std::pair<std::string, FlowAlgorithm>> algorithms = {
+            {"edmonds-karp", FlowAlgorithm::EDMONDS_KARP},
+            {"dinic", FlowAlgorithm::DINIC},
+            {"push-relabel", FlowAlgorithm::PUSH_RELABEL}};
+
+    int checks = 0;
+    int failed = 0;
+    auto report = [&](const std::string &network, size_t pipes, const std::string &engine, double timeMs, double ratio,
+                      double total, int differing, const std::string &error) {
+        checks++;
+        failed += !error.empty();
+        std::cout << network << ',' << pipes << ',' << engine << ',' << std::fixed << std::setprecision(3) << timeMs
+                  << ',' << ratio << ',' << std::setprecision(0) << total << ',' << differing << ','
+                  << (error.empty() ? "ok" : error) << std::endl;
+    };
+
+    std::cout << "network,pipes,engine,time_ms,ratio,total,cities_differing,status\n";
+    for (const DiffNetwork &network : networks) {
+        Graph g;
+        network.load(&g);
+        size_t pipes = g.getPipeSet().size();
+
+        EngineRun reference;
+        for (const auto &algorithm : algorithms) {
+            EngineRun run = runEngine(&g, algorithm.second, repeat);
+            if (algorithm.second == FlowAlgorithm::EDMONDS_KARP)
+                reference = run;
+            int differing = countDiffering(reference.flowPerCity, run.flowPerCity);
+            std::string error = run.error;
+            if (error.empty() && std::fabs(run.total - reference.total) > EPSILON)
+                error = "total differs from edmonds-karp";
+            if (error.empty() && differing > 0)
+                error = "city flows differ from edmonds-karp";
+            report(network.name, pipes, algorithm.first, run.timeMs, run.timeMs / std::max(reference.timeMs, 1e-9),
+                   run.total, differing, error);
+        }
+
+        // Repair random failures incrementally and compare with solving them from scratch
+        std::vector<ServicePoint *> stations;
+        for (ServicePoint *v : g.getServicePointSet()) {
+            if (dynamic_cast<Station *>(v) != nullptr)
+                stations.push_back(v);
+        }
+        Management incremental(&g);
+        Management full(&g);
+        full.setIncremental(false);
+        incremental.getScenarioCache().setCapacity(0);
+        full.getScenarioCache().setCapacity(0);
+        incremental.ensureBaseline();
+        full.ensureBaseline();
+        for (int i = 0; i < failures && !g.getPipeSet().empty(); i++) {
+            ServicePoint *failedStation = nullptr;
+            Pipe *failedPipe = nullptr;
+            if (i % 2 == 1 && !stations.empty())
+                failedStation = stations[rng() % stations.size()];
+            else
+                failedPipe = g.getPipeSet()[rng() % g.getPipeSet().size()];
+            auto start = std::chrono::steady_clock::now();
+            std::unordered_map<std::string,int> repaired = incremental.getMaxFlowAfterFailure(failedStation, failedPipe);
+            auto middle = std::chrono::steady_clock::now();
+            std::unordered_map<std::string,int> solved = full.getMaxFlowAfterFailure(failedStation, failedPipe);
+            auto end = std::chrono::steady_clock::now();
+            double repairMs = std::chrono::duration<double, std::milli>(middle - start).count();
+            double solveMs = std::chrono::duration<double, std::milli>(end - middle).count();
+            std::string target = failedStation != nullptr ? failedStation->getCode()
+                    : failedPipe->getOrig()->getCode() + "-" + failedPipe->getDest()->getCode();
+            int differing = countDiffering(solved, repaired);
+            std::string error;
+            if (sumFlow(repaired) != sumFlow(solved))
+                error = "total differs from a full solve";
+            else if (differing > 0)
+                error = "city flows differ from a full solve";
+            report(network.name, pipes, "repair " + target, repairMs, repairMs / std::max(solveMs, 1e-9),
+                   (double) sumFlow(repaired), differing, error);
+        }
+
+        // Find the crucial Pipes to random Cities in both modes, which must agree
+        for (int i = 0; i < crucialCities && (long) pipes <= crucialMaxPipes && !g.getCitiesSet().empty(); i++) {
+            ServicePoint *city = g.getCitiesSet()[rng() % g.getCitiesSet().size()];
+            auto start = std::chrono::steady_clock::now();
+            std::vector<std::pair<int,int>> found = getCrucialSet(incremental, city);
+            auto middle = std::chrono::steady_clock::now();
+            std::vector<std::pair<int,int>> expected = getCrucialSet(full, city);
+            auto end = std::chrono::steady_clock::now();
+            double incrementalMs = std::chrono::duration<double, std::milli>(middle - start).count();
+            double fullMs = std::chrono::duration<double, std::milli>(end - middle).count();
+            report(network.name, pipes, "crucial " + city->getCode(), incrementalMs,
+                   incrementalMs / std::max(fullMs, 1e-9), (double) found.size(), 0,
+                   found == expected ? "" : "crucial pipes differ from a full solve");
+        }
+
+        // Sweep every failure in both modes, which must agree
+        if ((long) pipes <= contingenciesMaxPipes) {
+            auto start = std::chrono::steady_clock::now();
+            std::vector<contingency> found = incremental.getContingencies();
+            auto middle = std::chrono::steady_clock::now();
+            std::vector<contingency> expected = full.getContingencies();
+            auto end = std::chrono::steady_clock::now();
+            double incrementalMs = std::chrono::duration<double, std::milli>(middle - start).count();
+            double fullMs = std::chrono::duration<double, std::milli>(end - middle).count();
+            int differing = countDifferingFailures(found, expected);
+            report(network.name, pipes, "contingencies", incrementalMs, incrementalMs / std::max(fullMs, 1e-9),
+                   (double) found.size(), differing, differing == 0 ? "" : "contingencies differ from a full solve");
+        }
+    }
+
+    std::cerr << checks << " checks, " << failed << " failed\n";
+    return failed == 0 ? 0 : 1;
+}
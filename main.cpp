@@ -1,11 +1,179 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
 #include "src/Graph.h"
 #include "src/Menu.h"
 #include "src/Auxiliar.h"
+#include "src/Snapshot.h"
+#include "src/Batch.h"
+#include "src/Server.h"
+#include "src/TraceRecorder.h"
 
-int main() {
+/**
+ * @brief Writes the spans recorded to the trace file, if one was asked for
+ * @param path
+ */
+static void writeTrace(const std::string &path) {
+    if (!path.empty() && !TraceRecorder::instance().write(path))
+        std::cerr << "Could not write the trace " << path << "\n";
+}
+
+/**
+ * @brief Prints the options of the program
+ * @param out
+ */
+static void printUsage(std::ostream &out) {
+    out << "Usage: Project1 [options]\n"
+        << "  --dataset <n>           read the CSV files of dataset n, 0 for the small one (default) and 1 for the large one\n"
+        << "  --dataset-dir <dir>     read the CSV files in the directory instead, named as in the large dataset\n"
+        << "  --load-snapshot <file>  start from a binary snapshot instead of the CSV files\n"
+        << "  --save-snapshot <file>  write the loaded network to a binary snapshot\n"
+        << "  --results <file>        reuse the baseline max flow stored in the file, or compute and store it\n"
+        << "  --batch <file>          run the query script in the file, - for the standard input, instead of the menu\n"
+        << "  --output <file>         write the batch results to the file instead of the standard output\n"
+        << "  --serve <socket>        answer queries on a Unix domain socket instead of showing the menu\n"
+        << "  --memory-report         print the memory held by the network after loading and after every query\n"
+        << "  --trace <file>          record the time spent loading, solving and formatting as Chrome trace events\n"
+        << "  --help                  print this message\n";
+}
+
+/**
+ * Options:
+ *  --dataset <n>           read the CSV files of dataset n, 0 for the small one (default) and 1 for the large one
+ *  --dataset-dir <dir>     read the CSV files in the directory instead, named as in the large dataset, such as the
+ *                          ones Project1Generate writes
+ *  --load-snapshot <file>  start from a binary snapshot instead of the CSV files
+ *  --save-snapshot <file>  write the loaded network to a binary snapshot
+ *  --results <file>        reuse the baseline max flow stored in the file, or compute and store it. Defaults to
+ *                          the snapshot file name followed by .results when a snapshot is loaded
+ *  --batch <file>          run the query script in the file, - for the standard input, instead of the menu
+ *  --output <file>         write the batch results to the file instead of the standard output
+ *  --serve <socket>        answer queries on a Unix domain socket instead of showing the menu
+ *  --memory-report         print the memory held by the network by category and the peak resident set size after
+ *                          loading, then after every query
+ *  --trace <file>          record the time spent loading, solving and formatting as Chrome trace events, written
+ *                          to the file on exit. Open it in chrome://tracing or ui.perfetto.dev
+ *
+ * An unknown option, an option without its value or a dataset other than 0 or 1 prints the usage and exits with 1.
+ */
+int main(int argc, char *argv[]) {
+    std::string datasetDirectory, loadPath, savePath, resultsPath, batchPath, outputPath, socketPath, tracePath;
+    int dataset = 0;
+    bool memoryReport = false;
+    try {
+        for (int i = 1; i < argc; i++) {
+            // Takes the value that follows the option
+            auto value = [&]() {
+                if (i + 1 == argc)
+                    throw std::logic_error(std::string("missing value of ") + argv[i]);
+                return argv[++i];
+            };
+            if (std::strcmp(argv[i], "--help") == 0) {
+                printUsage(std::cout);
+                return 0;
+            } else if (std::strcmp(argv[i], "--memory-report") == 0)
+                memoryReport = true;
+            else if (std::strcmp(argv[i], "--dataset") == 0) {
+                std::string n = value();
+                if (n != "0" && n != "1")
+                    throw std::logic_error("unknown dataset " + n);
+                dataset = n == "1";
+            } else if (std::strcmp(argv[i], "--dataset-dir") == 0)
+                datasetDirectory = value();
+            else if (std::strcmp(argv[i], "--load-snapshot") == 0)
+                loadPath = value();
+            else if (std::strcmp(argv[i], "--save-snapshot") == 0)
+                savePath = value();
+            else if (std::strcmp(argv[i], "--results") == 0)
+                resultsPath = value();
+            else if (std::strcmp(argv[i], "--batch") == 0)
+                batchPath = value();
+            else if (std::strcmp(argv[i], "--output") == 0)
+                outputPath = value();
+            else if (std::strcmp(argv[i], "--serve") == 0)
+                socketPath = value();
+            else if (std::strcmp(argv[i], "--trace") == 0)
+                tracePath = value();
+            else
+                throw std::logic_error(std::string("unknown option ") + argv[i]);
+        }
+    } catch (const std::logic_error &e) {
+        std::cerr << e.what() << "\n";
+        printUsage(std::cerr);
+        return 1;
+    }
+    if (!tracePath.empty())
+        TraceRecorder::instance().start();
+
+    auto readCsv = [&](Graph *g) {
+        if (datasetDirectory.empty())
+            Auxiliar::readDataset(g, dataset);
+        else
+            Auxiliar::readDatasetDirectory(g, datasetDirectory);
+    };
     Graph *g = new Graph();
-    Auxiliar::readDataset(g);
+    if (loadPath.empty()) {
+        readCsv(g);
+    } else if (!Snapshot::load(g, loadPath)) {
+        std::cerr << "Could not load the snapshot " << loadPath << ", reading the CSV files\n";
+        readCsv(g);
+    }
+    if (!savePath.empty() && !Snapshot::save(g, savePath))
+        std::cerr << "Could not write the snapshot " << savePath << "\n";
+
+    if (memoryReport) {
+        MemoryReport report;
+        g->addMemoryUsage(report);
+        report.peakRssKb = MemoryReport::getPeakRssKb();
+        std::cerr << "After loading: ";
+        report.print(std::cerr);
+    }
+
+    if (resultsPath.empty() && !loadPath.empty())
+        resultsPath = loadPath + ".results";
+
+    if (!socketPath.empty()) {
+        Server server(g, resultsPath);
+        bool served = server.run(socketPath);
+        writeTrace(tracePath);
+        return served ? 0 : 1;
+    }
+
+    if (!batchPath.empty()) {
+        Management m(g);
+        if (!resultsPath.empty() && !m.loadBaseline(resultsPath) && !m.saveBaseline(resultsPath))
+            std::cerr << "Could not write the results file " << resultsPath << "\n";
+        std::ifstream scriptFile;
+        std::ofstream outputFile;
+        if (batchPath != "-") {
+            scriptFile.open(batchPath);
+            if (!scriptFile) {
+                std::cerr << "Could not open the script " << batchPath << "\n";
+                return 1;
+            }
+        }
+        if (!outputPath.empty()) {
+            outputFile.open(outputPath);
+            if (!outputFile) {
+                std::cerr << "Could not open the output file " << outputPath << "\n";
+                return 1;
+            }
+        }
+        Batch batch(g, m);
+        batch.setMemoryReport(memoryReport);
+        batch.run(batchPath == "-" ? std::cin : scriptFile, outputPath.empty() ? std::cout : outputFile);
+        writeTrace(tracePath);
+        return 0;
+    }
+
     Menu menu = Menu(g);
+    menu.setMemoryReport(memoryReport);
+    menu.setDatasetFiles(datasetDirectory.empty() ? dataset : -1, loadPath, savePath, resultsPath);
+    if (!resultsPath.empty())
+        menu.usePrecomputedResults(resultsPath);
     menu.run();
+    writeTrace(tracePath);
     return 0;
-}
\ No newline at end of file
+}
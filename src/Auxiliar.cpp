@@ -1,10 +1,41 @@
 #include "Auxiliar.h"
+#include "CsvReader.h"
+#include "MappedFile.h"
 #include "Reservoir.h"
 #include "Station.h"
 #include "City.h"
-#include <sstream>
-#include <fstream>
-#include <algorithm>
+#include "ThreadPool.h"
+#include "TraceRecorder.h"
+#include <memory>
+
+/**
+ * @brief Pipe read from a row of a Pipes CSV file, with its ends resolved to code ids
+ */
+struct PipeRow {
+    uint32_t servicePointA;
+    uint32_t servicePointB;
+    int capacity;
+    bool directed;
+};
+
+/**
+ * @brief Parses the Pipe rows of a part of a Pipes CSV file
+ * @param g The main graph, only read, so several parts can be parsed at once
+ * @param text whole rows of the file
+ * @param rows where the Pipes are appended, in file order
+ * @details Time Complexity O(n) n = size of the text
+ */
+static void parsePipeRows(const Graph *g, std::string_view text, std::vector<PipeRow> &rows) {
+    CsvReader csv(text);
+    while (csv.nextRow()) {
+        PipeRow row{};
+        row.servicePointA = g->getSymbol(csv.nextField());
+        row.servicePointB = g->getSymbol(csv.nextField());
+        row.capacity = CsvReader::toInt(csv.nextField());
+        row.directed = CsvReader::toInt(csv.nextField()) != 0;
+        rows.push_back(row);
+    }
+}
 
 /**
  * @brief Reads the DataSet
@@ -12,12 +43,27 @@
  * @param dataset dataset to load
  */
 void Auxiliar::readDataset(Graph *g, int dataset) {
+    TRACE_SCOPE("load", "readDataset");
     readReservoir(g, dataset);
     readStations(g, dataset);
     readCities(g, dataset);
     readPipes(g, dataset);
 }
 
+/**
+ * @brief Reads a DataSet with the file names of the large one, such as a generated network
+ * @param g The main graph
+ * @param directory directory of Reservoir.csv, Stations.csv, Cities.csv and Pipes.csv
+ */
+void Auxiliar::readDatasetDirectory(Graph *g, const std::string &directory) {
+    TRACE_SCOPE("load", "readDataset");
+    std::string prefix = directory.empty() ? "" : directory + "/";
+    readReservoir(g, prefix + "Reservoir.csv");
+    readStations(g, prefix + "Stations.csv");
+    readCities(g, prefix + "Cities.csv");
+    readPipes(g, prefix + "Pipes.csv");
+}
+
 /**
  * @brief Reads the Reservoirs
  * @param g The main graph
@@ -28,22 +74,7 @@ void Auxiliar::readReservoir(Graph *g, int dataset) {
     std::string files[2];
     files[0] = "../data/Project1DataSetSmall/Reservoirs_Madeira.csv";
     files[1] = "../data/Project1LargeDataSet/Reservoir.csv";
-    std::ifstream file(files[dataset]);
-    std::string line;
-    std::string name, municipality, id, code, maxDelivery;
-
-    getline(file, line);
-    while (std::getline(file, line)){
-        std::istringstream ss(line);
-        getline(ss, name, ',');
-        getline(ss, municipality, ',');
-        getline(ss, id, ',');
-        getline(ss, code, ',');
-        getline(ss, maxDelivery, '\r');
-        Reservoir* reservoir = new Reservoir(name, municipality, id, code, std::stoi(maxDelivery));
-        g->addReservoir(reservoir);
-    }
-
+    readReservoir(g, files[dataset]);
 }
 
 /**
@@ -56,19 +87,7 @@ void Auxiliar::readStations(Graph *g, int dataset) {
     std::string files[2];
     files[0] = "../data/Project1DataSetSmall/Stations_Madeira.csv";
     files[1] = "../data/Project1LargeDataSet/Stations.csv";
-    std::ifstream file(files[dataset]);
-    std::string line;
-    std::string id, code;
-    getline(file, line);
-
-    while (std::getline(file, line)){
-        std::istringstream ss(line);
-        getline(ss, id, ',');
-        getline(ss, code, '\r');
-        Station* station = new Station(id, code);
-        g->addStation(station);
-    }
-
+    readStations(g, files[dataset]);
 }
 
 /**
@@ -81,51 +100,145 @@ void Auxiliar::readCities(Graph *g, int dataset) {
     std::string files[2];
     files[0] = "../data/Project1DataSetSmall/Cities_Madeira.csv";
     files[1] = "../data/Project1LargeDataSet/Cities.csv";
-    std::ifstream file(files[dataset]);
-    std::string line;
-    std::string name, id, code, demand, population;
-
-    getline(file, line);
-    while (std::getline(file, line)){
-        std::istringstream ss(line);
-        getline(ss, name, ',');
-        getline(ss, id, ',');
-        getline(ss, code, ',');
-        getline(ss, demand, ',');
-        getline(ss, population, '\r');
-        std::replace(population.begin(),population.end(),'\"',' ');
-        City* city = new City(name, id, code, std::stoi(demand), std::stoi(population));
-        g->addCity(city);
-    }
-
+    readCities(g, files[dataset]);
 }
 
 /**
  * @brief Reads the Pipes
  * @param g The main graph
  * @param dataset dataset to load
- * @param dataset Time Complexity O(n) n = number of pipes
+ * @details Time Complexity O(n) n = number of pipes
  */
 void Auxiliar::readPipes(Graph *g, int dataset) {
     std::string files[2];
     files[0] = "../data/Project1DataSetSmall/Pipes_Madeira.csv";
     files[1] = "../data/Project1LargeDataSet/Pipes.csv";
-    std::ifstream file(files[dataset]);
-    std::string line;
-    std::string servicePointA, servicePointB, capacity, direction;
-
-    getline(file, line);
-    while (std::getline(file, line)){
-        std::istringstream ss(line);
-        getline(ss, servicePointA, ',');
-        getline(ss, servicePointB, ',');
-        getline(ss, capacity, ',');
-        getline(ss, direction, '\r');
-        if (std::stoi(direction)){
-            g->addPipe(servicePointA, servicePointB, std::stoi(capacity));
-        }
-        else {
-            g->addBidirectionalPipe(servicePointA, servicePointB, std::stoi(capacity));
+    readPipes(g, files[dataset]);
+}
+
+/**
+ * @brief Reads the Reservoirs from a CSV file with the columns name, municipality, id, code and maximum delivery
+ * @param g The main graph
+ * @param path
+ * @details Time Complexity O(n) n = size of the file
+ */
+void Auxiliar::readReservoir(Graph *g, const std::string &path) {
+    TRACE_SCOPE("load", "readReservoir");
+    MappedFile file(path);
+    CsvReader csv(file.getContents());
+    g->reserveServicePoints(CsvReader::countRows(file.getContents()));
+
+    csv.nextRow();
+    while (csv.nextRow()) {
+        std::string name(csv.nextField());
+        std::string municipality(csv.nextField());
+        std::string id(csv.nextField());
+        std::string code(csv.nextField());
+        int maxDelivery = CsvReader::toInt(csv.nextField());
+        auto reservoir = std::make_unique<Reservoir>(name, municipality, id, code, maxDelivery);
+        g->addReservoir(reservoir.get());
+        reservoir.release();
+    }
+}
+
+/**
+ * @brief Reads the Stations from a CSV file with the columns id and code
+ * @param g The main graph
+ * @param path
+ * @details Time Complexity O(n) n = size of the file
+ */
+void Auxiliar::readStations(Graph *g, const std::string &path) {
+    TRACE_SCOPE("load", "readStations");
+    MappedFile file(path);
+    CsvReader csv(file.getContents());
+    g->reserveServicePoints(CsvReader::countRows(file.getContents()));
+
+    csv.nextRow();
+    while (csv.nextRow()) {
+        std::string id(csv.nextField());
+        std::string code(csv.nextField());
+        auto station = std::make_unique<Station>(id, code);
+        g->addStation(station.get());
+        station.release();
+    }
+}
+
+/**
+ * @brief Reads the Cities from a CSV file with the columns name, id, code, demand and population. The population
+ * may be quoted with thousands separators, such as "2,517"
+ * @param g The main graph
+ * @param path
+ * @details Time Complexity O(n) n = size of the file
+ */
+void Auxiliar::readCities(Graph *g, const std::string &path) {
+    TRACE_SCOPE("load", "readCities");
+    MappedFile file(path);
+    CsvReader csv(file.getContents());
+    g->reserveServicePoints(CsvReader::countRows(file.getContents()));
+
+    csv.nextRow();
+    while (csv.nextRow()) {
+        std::string name(csv.nextField());
+        std::string id(csv.nextField());
+        std::string code(csv.nextField());
+        int demand = CsvReader::toInt(csv.nextField());
+        int population = CsvReader::toInt(csv.nextField());
+        auto city = std::make_unique<City>(name, id, code, demand, population);
+        g->addCity(city.get());
+        city.release();
+    }
+}
+
+/**
+ * @brief Reads the Pipes from a CSV file with the columns origin code, destination code, capacity and direction,
+ * 1 for a Pipe only from origin to destination and 0 for a bidirectional Pipe
+ * @param g The main graph
+ * @param path
+ * @details Large files are split in chunks of whole rows, parsed by several threads. The Pipes are then added in
+ * file order, so the Graph is the same as when the rows are read one by one.
+ * Time Complexity O(n/T + P) n = size of the file, T = number of threads, P = number of pipes
+ */
+void Auxiliar::readPipes(Graph *g, const std::string &path) {
+    TRACE_SCOPE("load", "readPipes");
+    const size_t chunkSize = 1 << 20;
+    MappedFile file(path);
+    std::string_view text = file.getContents();
+    size_t header = text.find('\n');
+    text = header == std::string_view::npos ? std::string_view() : text.substr(header + 1);
+
+    // Split the rows in chunks that end at a line ending
+    std::vector<std::string_view> chunks;
+    while (!text.empty()) {
+        size_t end = text.size() <= chunkSize ? std::string_view::npos : text.find('\n', chunkSize);
+        end = end == std::string_view::npos ? text.size() : end + 1;
+        chunks.push_back(text.substr(0, end));
+        text.remove_prefix(end);
+    }
+
+    std::vector<std::vector<PipeRow>> rows(chunks.size());
+    if (chunks.size() > 1) {
+        ThreadPool pool;
+        pool.parallelFor(chunks.size(), [&](size_t chunk, unsigned /*worker*/) {
+            TRACE_SCOPE("load", "parsePipeRows");
+            parsePipeRows(g, chunks[chunk], rows[chunk]);
+        });
+    } else if (chunks.size() == 1) {
+        parsePipeRows(g, chunks[0], rows[0]);
+    }
+
+    TRACE_SCOPE("load", "addPipes");
+    size_t pipeCount = 0;
+    for (const std::vector<PipeRow> &chunkRows : rows)
+        pipeCount += chunkRows.size();
+    g->reservePipes(2 * pipeCount);
+    for (const std::vector<PipeRow> &chunkRows : rows) {
+        for (const PipeRow &row : chunkRows) {
+            if (row.directed){
+                g->addPipe(row.servicePointA, row.servicePointB, row.capacity);
+            }
+            else {
+                g->addBidirectionalPipe(row.servicePointA, row.servicePointB, row.capacity);
+            }
         }
     }
 }
@@ -8,10 +8,16 @@
 class Auxiliar {
 public:
     static void readDataset(Graph *g, int dataset = 0);
+    static void readDatasetDirectory(Graph *g, const std::string &directory);
     static void readReservoir(Graph *g, int dataset);
     static void readStations(Graph *g, int dataset);
     static void readCities(Graph *g, int dataset);
     static void readPipes(Graph *g, int dataset);
+
+    static void readReservoir(Graph *g, const std::string &path);
+    static void readStations(Graph *g, const std::string &path);
+    static void readCities(Graph *g, const std::string &path);
+    static void readPipes(Graph *g, const std::string &path);
 };
 
 #endif //PROJECT1_AUXILIAR_H
@@ -0,0 +1,316 @@
+#include "Batch.h"
+#include "TraceRecorder.h"
+#include <sstream>
+#include <stdexcept>
+
+/**
+ * @brief Quotes a CSV field if it holds a comma, a quote or a line ending
+ * @param field
+ * @return CSV field
+ */
+static std::string csvField(const std::string &field) {
+    if (field.find_first_of(",\"\r\n") == std::string::npos)
+        return field;
+    std::string quoted = "\"";
+    for (char c : field) {
+        if (c == '"')
+            quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+/**
+ * @brief Batch Constructor
+ * @param g Graph the queries run on
+ * @param m Management that answers them, keeping its baseline between commands
+ */
+Batch::Batch(Graph *g, Management &m): g(g), m(m) {}
+
+/**
+ * @brief Sets whether every command is followed by a row with the peak resident set size after it
+ * @param report
+ */
+void Batch::setMemoryReport(bool report) {
+    memoryReport = report;
+}
+
+/**
+ * @brief Writes the CSV header of the result rows
+ * @param out
+ */
+void Batch::writeHeader(std::ostream &out) {
+    out << "line,query,target,code,value,new_value\n";
+}
+
+/**
+ * @brief Runs every command of a script, writing the header and then the rows of each command
+ * @param script
+ * @param out
+ */
+void Batch::run(std::istream &script, std::ostream &out) {
+    writeHeader(out);
+    std::string command;
+    int line = 0;
+    while (std::getline(script, command)) {
+        line++;
+        execute(command, line, out);
+    }
+    out.flush();
+}
+
+/**
+ * @brief Runs one command, writing its rows
+ * @param command line of a script
+ * @param line number of the line, repeated in every row
+ * @param out
+ */
+void Batch::execute(const std::string &command, int line, std::ostream &out) {
+    std::istringstream ss(command);
+    std::string name, arg;
+    std::vector<std::string> args;
+    ss >> name;
+    while (ss >> arg)
+        args.push_back(arg);
+    if (name.empty() || name[0] == '#')
+        return;
+    TRACE_SCOPE("batch", name);
+
+    std::string target;
+    for (size_t i = 0; i < args.size(); i++)
+        target += (i > 0 ? "-" : "") + args[i];
+    std::vector<Row> rows;
+    m.resetSolverStats();
+    try {
+        rows = query(name, args);
+    } catch (const std::exception &e) {
+        name = "error";
+        target = command;
+        rows = {{e.what(), "", ""}};
+    }
+    TRACE_SCOPE("format", "write rows");
+    for (const Row &row : rows) {
+        out << line << ',' << csvField(name) << ',' << csvField(row.target.empty() ? target : row.target) << ',' << csvField(row.code) << ','
+            << row.value << ',' << row.newValue << '\n';
+    }
+    if (SolverStats::ENABLED) {
+        for (const Row &row : statsRows(m.getSolverStats())) {
+            out << line << ",stats," << csvField(name) << ',' << row.code << ',' << row.value << ",\n";
+        }
+    }
+    if (memoryReport)
+        out << line << ",memory," << csvField(name) << ",peak_rss_kb," << MemoryReport::getPeakRssKb() << ",\n";
+}
+
+/**
+ * @brief Turns the solver counters and phase times of a command into rows
+ * @param stats
+ * @return rows, with the times in milliseconds
+ */
+std::vector<Batch::Row> Batch::statsRows(const SolverStats &stats) {
+    return {{"searches", std::to_string(stats.searches), ""},
+            {"arcs_scanned", std::to_string(stats.arcsScanned), ""},
+            {"augmentations", std::to_string(stats.augmentations), ""},
+            {"relabels", std::to_string(stats.relabels), ""},
+            {"setup_ms", std::to_string(stats.phaseSeconds[(int) SolverPhase::SETUP] * 1000), ""},
+            {"solve_ms", std::to_string(stats.phaseSeconds[(int) SolverPhase::SOLVE] * 1000), ""},
+            {"teardown_ms", std::to_string(stats.phaseSeconds[(int) SolverPhase::TEARDOWN] * 1000), ""}};
+}
+
+/**
+ * @brief Turns a memory report into rows
+ * @param report
+ * @return rows, with the categories in bytes
+ */
+std::vector<Batch::Row> Batch::memoryRows(const MemoryReport &report) {
+    return {{"nodes", std::to_string(report.nodes), ""},
+            {"pipes", std::to_string(report.pipes), ""},
+            {"adjacency", std::to_string(report.adjacency), ""},
+            {"indexes", std::to_string(report.indexes), ""},
+            {"strings", std::to_string(report.strings), ""},
+            {"solver_scratch", std::to_string(report.solverScratch), ""},
+            {"total", std::to_string(report.total()), ""},
+            {"peak_rss_kb", std::to_string(report.peakRssKb), ""}};
+}
+
+/**
+ * @brief Answers one command
+ * @param name command
+ * @param args arguments of the command
+ * @return result rows
+ * @details Throws a logic_error if the command or its arguments are not valid
+ */
+std::vector<Batch::Row> Batch::query(const std::string &name, const std::vector<std::string> &args) {
+    auto expectArgs = [&](size_t count) {
+        if (args.size() != count)
+            throw std::logic_error(name + " takes " + std::to_string(count) + " argument(s)");
+    };
+
+    if (name == "maxflow") {
+        expectArgs(0);
+        return flowRows(m.getMaxFlow(), true);
+    }
+    if (name == "city") {
+        expectArgs(1);
+        std::pair<std::string,int> flow = m.getMaxFlowCity(requireServicePoint(args[0], "City"));
+        return {{flow.first, std::to_string(flow.second), ""}};
+    }
+    if (name == "deficit") {
+        expectArgs(0);
+        return flowRows(m.getFlowDeficit(), false);
+    }
+    if (name == "balance") {
+        expectArgs(0);
+        m.getMaxFlow();
+        float avg = m.getAveragePipePressure() * 100;
+        float var = m.getVariancePipePressure() * 100;
+        std::vector<Row> rows = flowRows(m.getMaxFlowBalance(), true);
+        rows.push_back({"average_pressure_pct", std::to_string(avg), std::to_string(m.getAveragePipePressure() * 100)});
+        rows.push_back({"variance_pressure_pct", std::to_string(var), std::to_string(m.getVariancePipePressure() * 100)});
+        return rows;
+    }
+    if (name == "metrics") {
+        expectArgs(0);
+        return {{"average_pressure_pct", std::to_string(m.getAveragePipePressure() * 100), ""},
+                {"variance_pressure_pct", std::to_string(m.getVariancePipePressure() * 100), ""}};
+    }
+    if (name == "reservoir") {
+        expectArgs(1);
+        return affectedRows(m.getCitiesAffectedByReservoirFail(requireServicePoint(args[0], "Reservoir")));
+    }
+    if (name == "station") {
+        expectArgs(1);
+        return affectedRows(m.getCitiesAffectedByStationFail(requireServicePoint(args[0], "Station")));
+    }
+    if (name == "pipe") {
+        expectArgs(2);
+        Pipe *pipe = g->getPipeByEnds(args[0], args[1]);
+        if (pipe == nullptr)
+            throw std::logic_error("no Pipe from " + args[0] + " to " + args[1]);
+        return affectedRows(m.getCitiesAffectedByPipeRupture(pipe));
+    }
+    if (name == "crucial") {
+        expectArgs(1);
+        std::vector<Row> rows;
+        for (const std::pair<Pipe *, flowDiff> &crucial : m.getCrucialPipesToCity(requireServicePoint(args[0], "City"))) {
+            rows.push_back({pipeName(crucial.first), std::to_string(crucial.second.oldFlow), std::to_string(crucial.second.newFlow)});
+        }
+        return rows;
+    }
+    if (name == "contingencies") {
+        expectArgs(0);
+        std::vector<Row> rows;
+        for (const contingency &c : m.getContingencies()) {
+            std::string failure = c.servicePoint != nullptr ? c.servicePoint->getCode() : pipeName(c.pipe);
+            std::vector<Row> affected = affectedRows(c.citiesAffected, failure);
+            rows.insert(rows.end(), affected.begin(), affected.end());
+        }
+        return rows;
+    }
+    if (name == "algorithm") {
+        expectArgs(1);
+        if (args[0] == "edmonds-karp")
+            m.setAlgorithm(FlowAlgorithm::EDMONDS_KARP);
+        else if (args[0] == "dinic")
+            m.setAlgorithm(FlowAlgorithm::DINIC);
+        else if (args[0] == "push-relabel")
+            m.setAlgorithm(FlowAlgorithm::PUSH_RELABEL);
+        else
+            throw std::logic_error("unknown algorithm " + args[0]);
+        return {};
+    }
+    if (name == "incremental") {
+        expectArgs(1);
+        if (args[0] != "on" && args[0] != "off")
+            throw std::logic_error("incremental takes on or off");
+        m.setIncremental(args[0] == "on");
+        return {};
+    }
+    if (name == "cache") {
+        if (args.size() > 1)
+            throw std::logic_error("cache takes 0 or 1 argument(s)");
+        ScenarioCache &cache = m.getScenarioCache();
+        if (args.size() == 1) {
+            if (args[0].empty() || args[0].find_first_not_of("0123456789") != std::string::npos)
+                throw std::logic_error("cache takes the number of scenarios kept");
+            cache.setCapacity(std::stoul(args[0]));
+        }
+        return {{"hits", std::to_string(cache.getHits()), ""},
+                {"misses", std::to_string(cache.getMisses()), ""},
+                {"size", std::to_string(cache.size()), std::to_string(cache.getCapacity())},
+                {"evictions", std::to_string(cache.getEvictions()), ""},
+                {"invalidations", std::to_string(cache.getInvalidations()), ""}};
+    }
+    if (name == "memory") {
+        expectArgs(0);
+        return memoryRows(m.getMemoryReport());
+    }
+    throw std::logic_error("unknown command " + name);
+}
+
+/**
+ * @brief Gets a ServicePoint by code, checking its kind
+ * @param code
+ * @param kind "Reservoir", "Station" or "City"
+ * @return ServicePoint
+ * @details Throws a logic_error if there is no ServicePoint of that kind with the code
+ */
+ServicePoint * Batch::requireServicePoint(const std::string &code, const char *kind) {
+    ServicePoint *v = g->findServicePoint(code);
+    std::string k = kind;
+    bool matches = (k == "Reservoir" && dynamic_cast<Reservoir *>(v) != nullptr)
+                   || (k == "Station" && dynamic_cast<Station *>(v) != nullptr)
+                   || (k == "City" && dynamic_cast<City *>(v) != nullptr);
+    if (!matches)
+        throw std::logic_error(std::string("no ") + kind + " with code " + code);
+    return v;
+}
+
+/**
+ * @brief Names a Pipe by its ends
+ * @param e
+ * @return "origin-destination"
+ */
+std::string Batch::pipeName(Pipe *e) {
+    return e->getOrig()->getCode() + "-" + e->getDest()->getCode();
+}
+
+/**
+ * @brief Turns a value per City into rows, in code order
+ * @param flowPerCity
+ * @param total add a TOTAL row with the sum
+ * @return rows
+ */
+std::vector<Batch::Row> Batch::flowRows(const std::unordered_map<std::string,int> &flowPerCity, bool total) {
+    std::vector<Row> rows;
+    long sum = 0;
+    for (ServicePoint *city : g->getCitiesByCode()) {
+        auto it = flowPerCity.find(city->getCode());
+        if (it == flowPerCity.end())
+            continue;
+        rows.push_back({it->first, std::to_string(it->second), ""});
+        sum += it->second;
+    }
+    if (total)
+        rows.push_back({"TOTAL", std::to_string(sum), ""});
+    return rows;
+}
+
+/**
+ * @brief Turns the Cities affected by a failure into rows with the old and new flow, in code order
+ * @param cities
+ * @param target - failure the rows are about, or empty for the argument of the command
+ * @return rows
+ * @details Time Complexity O(C log C), C = number of Cities
+ */
+std::vector<Batch::Row> Batch::affectedRows(const std::vector<std::pair<std::string, flowDiff>> &cities, const std::string &target) {
+    std::unordered_map<std::string, flowDiff> byCode(cities.begin(), cities.end());
+    std::vector<Row> rows;
+    for (ServicePoint *city : g->getCitiesByCode()) {
+        auto it = byCode.find(city->getCode());
+        if (it == byCode.end())
+            continue;
+        rows.push_back({it->first, std::to_string(it->second.oldFlow), std::to_string(it->second.newFlow), target});
+    }
+    return rows;
+}
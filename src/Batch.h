@@ -0,0 +1,61 @@
+#ifndef PROJECT1_BATCH_H
+#define PROJECT1_BATCH_H
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include "Management.h"
+
+/**
+ * @brief Runs query scripts without the interactive Menu and writes the results as CSV
+ * @details A script has one command per line, with its arguments split by spaces. Empty lines and lines starting
+ * with '#' are skipped. The commands are:
+ *  - maxflow: flow reaching each City
+ *  - city <code>: max flow that can reach one City
+ *  - deficit: Cities that do not get their demand
+ *  - balance: flow reaching each City after balancing the load, with the pressure before and after
+ *  - metrics: average and variance of the pressure of the last query
+ *  - reservoir <code>, station <code>, pipe <origin> <destination>: Cities affected by the failure
+ *  - crucial <code>: Pipes whose rupture affects a City
+ *  - contingencies: Cities affected by every failure
+ *  - algorithm edmonds-karp|dinic|push-relabel, incremental on|off: settings for the next commands
+ *  - cache [capacity]: counters of the cache of failure scenarios, after setting how many it keeps
+ *  - memory: bytes held by the network and the solver state by category, and the peak resident set size in KiB
+ *
+ * Every result is a row "line,query,target,code,value,new_value": the script line, the command, its argument, the
+ * City or Pipe the row is about, and one or two numbers. The rows of contingencies name the failure as target. A command that fails gives a single row with the query
+ * "error" and the message in the code column. When the project is configured with PROJECT1_SOLVER_STATS, every command
+ * is followed by "stats" rows holding the solver counters and phase times it took, with the command as target.
+ * With setMemoryReport, every command is also followed by a "memory" row holding the peak resident set size after it.
+ */
+class Batch {
+public:
+    Batch(Graph *g, Management &m);
+
+    void run(std::istream &script, std::ostream &out);
+    void execute(const std::string &command, int line, std::ostream &out);
+    static void writeHeader(std::ostream &out);
+    void setMemoryReport(bool report);
+
+private:
+    struct Row {
+        std::string code;
+        std::string value;
+        std::string newValue;
+        std::string target = ""; // replaces the argument of the command when not empty
+    };
+
+    std::vector<Row> query(const std::string &name, const std::vector<std::string> &args);
+    ServicePoint * requireServicePoint(const std::string &code, const char *kind);
+    static std::string pipeName(Pipe *e);
+    std::vector<Row> flowRows(const std::unordered_map<std::string,int> &flowPerCity, bool total);
+    std::vector<Row> affectedRows(const std::vector<std::pair<std::string, flowDiff>> &cities, const std::string &target = "");
+    static std::vector<Row> statsRows(const SolverStats &stats);
+    static std::vector<Row> memoryRows(const MemoryReport &report);
+
+    Graph *g;
+    Management &m;
+    bool memoryReport = false;
+};
+
+#endif //PROJECT1_BATCH_H
@@ -48,3 +48,15 @@ int City::getDemand() {
 int City::getPopulation() {
     return this->population;
 }
+
+/**
+ * @brief Adds the bytes of the City, its Pipe lists and its strings to a report
+ * @param report
+ */
+void City::addMemoryUsage(MemoryReport &report) const {
+    ServicePoint::addMemoryUsage(report);
+    report.nodes += sizeof(City);
+    report.strings += MemoryReport::stringBytes(name);
+    report.strings += MemoryReport::stringBytes(id);
+    report.strings += MemoryReport::stringBytes(code);
+}
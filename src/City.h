@@ -17,6 +17,8 @@ public:
     int getDemand();
     int getPopulation();
 
+    void addMemoryUsage(MemoryReport &report) const override;
+
 private:
     std::string name;
     std::string id;
@@ -0,0 +1,99 @@
+#include "CsvReader.h"
+#include <charconv>
+#include <stdexcept>
+#include <string>
+
+/**
+ * @brief CsvReader Constructor
+ * @param text CSV text, which must outlive the reader and the fields it returns
+ */
+CsvReader::CsvReader(std::string_view text): text(text) {}
+
+/**
+ * @brief Moves to the next row that is not empty
+ * @return false if there are no rows left
+ * @details Time Complexity O(n) n = length of the row
+ */
+bool CsvReader::nextRow() {
+    while (next < text.size()) {
+        std::size_t end = text.find('\n', next);
+        if (end == std::string_view::npos)
+            end = text.size();
+        field = next;
+        rowEnd = end;
+        next = end + 1;
+        if (rowEnd > field && text[rowEnd - 1] == '\r')
+            rowEnd--;
+        if (rowEnd > field)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Gets the next field of the current row
+ * @return field, without its quotes. It is empty once the row has no fields left
+ * @details Time Complexity O(n) n = length of the field
+ */
+std::string_view CsvReader::nextField() {
+    if (field > rowEnd)
+        return {};
+    std::string_view row = text.substr(0, rowEnd);
+    std::size_t start = field;
+    std::size_t end;
+    if (start < rowEnd && row[start] == '"') {
+        start++;
+        end = row.find('"', start);
+        if (end == std::string_view::npos)
+            end = rowEnd;
+        std::size_t comma = row.find(',', end);
+        field = comma == std::string_view::npos ? rowEnd + 1 : comma + 1;
+    } else {
+        end = row.find(',', start);
+        if (end == std::string_view::npos)
+            end = rowEnd;
+        field = end + 1;
+    }
+    return row.substr(start, end - start);
+}
+
+/**
+ * @brief Parses the integer part of a number, such as 2750, "2,517" or 52.00
+ * @param field
+ * @return number
+ * @details Throws an invalid_argument if the field does not start with a number
+ */
+int CsvReader::toInt(std::string_view field) {
+    while (!field.empty() && field.front() == ' ')
+        field.remove_prefix(1);
+
+    // Thousands separators are dropped, which needs a copy
+    std::string digits;
+    if (field.find(',') != std::string_view::npos) {
+        for (char c : field) {
+            if (c != ',')
+                digits.push_back(c);
+        }
+        field = digits;
+    }
+
+    int value = 0;
+    auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+    if (result.ec != std::errc()) {
+        throw std::invalid_argument("Invalid number in CSV field: " + std::string(field));
+    }
+    return value;
+}
+
+/**
+ * @brief Counts the line endings of CSV text, an upper bound of its rows used to size containers upfront
+ * @param text
+ * @return number of rows
+ * @details Time Complexity O(n) n = length of the text
+ */
+std::size_t CsvReader::countRows(std::string_view text) {
+    std::size_t rows = 0;
+    for (char c : text)
+        rows += c == '\n';
+    return rows + (!text.empty() && text.back() != '\n');
+}
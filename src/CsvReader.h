@@ -0,0 +1,29 @@
+#ifndef PROJECT1_CSVREADER_H
+#define PROJECT1_CSVREADER_H
+
+#include <cstddef>
+#include <string_view>
+
+/**
+ * @brief Reads the rows and fields of CSV text in place, without copying them
+ * @details Rows end in '\n' or "\r\n" and empty rows are skipped. A field between double quotes may hold commas,
+ * and the quotes are not part of the field.
+ */
+class CsvReader {
+public:
+    explicit CsvReader(std::string_view text);
+
+    bool nextRow();
+    std::string_view nextField();
+
+    static int toInt(std::string_view field);
+    static std::size_t countRows(std::string_view text);
+
+private:
+    std::string_view text;
+    std::size_t next = 0; // start of the next row
+    std::size_t field = 0; // start of the next field of the current row
+    std::size_t rowEnd = 0; // end of the current row, without the line ending
+};
+
+#endif //PROJECT1_CSVREADER_H
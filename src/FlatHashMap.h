@@ -0,0 +1,172 @@
+#ifndef PROJECT1_FLATHASHMAP_H
+#define PROJECT1_FLATHASHMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Hash map from 64-bit integer keys to values, stored in flat arrays with linear probing
+ * @details Meant for keys packed from dense ids, such as the two ends of a Pipe. A lookup hashes one integer and
+ * scans neighbouring slots, with no allocation per entry. The key with every bit set is reserved to mark empty
+ * slots. Erasing shifts the following entries back, so no tombstones are left behind.
+ */
+template <typename V>
+class FlatHashMap {
+public:
+    /**
+     * @brief Packs two 32-bit ids into a key
+     * @param a
+     * @param b
+     * @return key
+     */
+    static uint64_t key(uint32_t a, uint32_t b) {
+        return ((uint64_t) a << 32) | b;
+    }
+
+    FlatHashMap() {
+        rehash(16);
+    }
+
+    /**
+     * @brief Finds the value of a key
+     * @param k
+     * @return pointer to the value, nullptr if the key is not in the map. It is valid until the map changes
+     * @details Time Complexity O(1) on average
+     */
+    V * find(uint64_t k) {
+        for (std::size_t i = slot(k); keys[i] != EMPTY; i = (i + 1) & mask) {
+            if (keys[i] == k)
+                return &values[i];
+        }
+        return nullptr;
+    }
+
+    const V * find(uint64_t k) const {
+        return const_cast<FlatHashMap *>(this)->find(k);
+    }
+
+    /**
+     * @brief Inserts a key, or replaces its value if it is already in the map
+     * @param k
+     * @param value
+     * @details Time Complexity O(1) amortized
+     */
+    void insert(uint64_t k, const V &value) {
+        if ((count + 1) * 8 > keys.size() * 7)
+            rehash(keys.size() * 2);
+        std::size_t i = slot(k);
+        while (keys[i] != EMPTY && keys[i] != k)
+            i = (i + 1) & mask;
+        if (keys[i] == EMPTY)
+            count++;
+        keys[i] = k;
+        values[i] = value;
+    }
+
+    /**
+     * @brief Removes a key
+     * @param k
+     * @return true if the key was in the map
+     * @details Time Complexity O(1) on average
+     */
+    bool erase(uint64_t k) {
+        std::size_t i = slot(k);
+        while (keys[i] != k) {
+            if (keys[i] == EMPTY)
+                return false;
+            i = (i + 1) & mask;
+        }
+        // Move back every following entry that would no longer be reachable from its home slot
+        std::size_t j = i;
+        while (true) {
+            j = (j + 1) & mask;
+            if (keys[j] == EMPTY)
+                break;
+            std::size_t home = slot(keys[j]);
+            if (((j - home) & mask) >= ((j - i) & mask)) {
+                keys[i] = keys[j];
+                values[i] = values[j];
+                i = j;
+            }
+        }
+        keys[i] = EMPTY;
+        values[i] = V();
+        count--;
+        return true;
+    }
+
+    /**
+     * @brief Makes room for n keys without rehashing
+     * @param n
+     */
+    void reserve(std::size_t n) {
+        std::size_t capacity = keys.size();
+        while (n * 8 > capacity * 7)
+            capacity *= 2;
+        if (capacity != keys.size())
+            rehash(capacity);
+    }
+
+    std::size_t size() const {
+        return count;
+    }
+
+    /**
+     * @brief Gets the bytes of the table
+     * @return bytes
+     */
+    std::size_t getMemoryUsage() const {
+        return keys.capacity() * sizeof(uint64_t) + values.capacity() * sizeof(V);
+    }
+
+    void clear() {
+        rehash(16);
+    }
+
+private:
+    static constexpr uint64_t EMPTY = UINT64_MAX;
+
+    /**
+     * @brief Gets the home slot of a key, mixing its bits so that consecutive ids spread over the table
+     * @param k
+     * @return slot
+     */
+    std::size_t slot(uint64_t k) const {
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccdULL;
+        k ^= k >> 33;
+        return (std::size_t) k & mask;
+    }
+
+    /**
+     * @brief Moves every entry to a new table
+     * @param capacity power of two
+     * @details Time Complexity O(capacity)
+     */
+    void rehash(std::size_t capacity) {
+        std::vector<uint64_t> oldKeys(capacity, EMPTY);
+        std::vector<V> oldValues(capacity);
+        oldKeys.swap(keys);
+        oldValues.swap(values);
+        mask = capacity - 1;
+        count = 0;
+        for (std::size_t i = 0; i < oldKeys.size(); i++) {
+            if (oldKeys[i] == EMPTY)
+                continue;
+            std::size_t j = slot(oldKeys[i]);
+            while (keys[j] != EMPTY)
+                j = (j + 1) & mask;
+            keys[j] = oldKeys[i];
+            values[j] = oldValues[i];
+            count++;
+        }
+    }
+
+    std::vector<uint64_t> keys;
+    std::vector<V> values;
+    std::size_t count = 0;
+    std::size_t mask = 0;
+};
+
+#endif //PROJECT1_FLATHASHMAP_H
@@ -0,0 +1,331 @@
+#include <algorithm>
+#include "FlowState.h"
+
+/**
+ * @brief FlowState Constructor, sized for every ServicePoint and Pipe of a residual graph snapshot
+ * @param r snapshot the state refers to
+ */
+FlowState::FlowState(const ResidualGraph &r) {
+    resize(r);
+}
+
+/**
+ * @brief Grows the state to fit ServicePoints and Pipes added to the Graph since it was sized. Existing values are kept
+ * @param r snapshot the state refers to
+ * @details Time Complexity O(1) if nothing was added, O(S+P) otherwise, S = number of ServicePoints, P = number of Pipes
+ */
+void FlowState::resize(const ResidualGraph &r) {
+    size_t pipes = r.getPipeCount();
+    if (flow.size() < pipes) {
+        flow.resize(pipes, 0);
+        capacityCap.resize(pipes, INF);
+        failedPipes.resize(pipes, false);
+    }
+    size_t servicePoints = r.getServicePointCount();
+    if (path.size() < servicePoints) {
+        path.resize(servicePoints, -1);
+        visited.resize(servicePoints, 0);
+        level.resize(servicePoints, -1);
+        currentArc.resize(servicePoints, 0);
+        height.resize(servicePoints, 0);
+        excess.resize(servicePoints, 0);
+        failedServicePoints.resize(servicePoints, false);
+        queue.reserve(servicePoints);
+    }
+}
+
+/**
+ * @brief Sets the flow of every Pipe to 0 and clears paths, visits and excesses. Capacity caps and failed elements are kept
+ * @details Time Complexity O(S+P), S = number of ServicePoints, P = number of Pipes
+ */
+void FlowState::reset() {
+    std::fill(flow.begin(), flow.end(), 0);
+    std::fill(path.begin(), path.end(), -1);
+    std::fill(excess.begin(), excess.end(), 0);
+    clearVisited();
+}
+
+/**
+ * @brief Marks every ServicePoint as not visited by starting a new epoch
+ * @details Time Complexity O(1), O(S) once every 2³² calls
+ */
+void FlowState::clearVisited() {
+    if (++epoch == 0) {
+        std::fill(visited.begin(), visited.end(), 0);
+        epoch = 1;
+    }
+}
+
+/**
+ * @brief Removes every ServicePoint from the level graph and rewinds their current arcs
+ * @details Time Complexity O(S), S = number of ServicePoints
+ */
+void FlowState::clearLevels() {
+    std::fill(level.begin(), level.end(), -1);
+    std::fill(currentArc.begin(), currentArc.end(), 0);
+}
+
+/**
+ * @brief Removes every capacity cap, each Pipe can use its full capacity again
+ * @details Time Complexity O(P), P = number of Pipes
+ */
+void FlowState::clearCapacityCaps() {
+    std::fill(capacityCap.begin(), capacityCap.end(), INF);
+}
+
+/**
+ * @brief Gets an empty queue for a Breadth-First Search, used as an array with a moving head. It can hold every
+ * ServicePoint without reallocating
+ * @return queue
+ */
+std::vector<int> & FlowState::getQueue() {
+    queue.clear();
+    return queue;
+}
+
+/**
+ * @brief Gets the flow of a Pipe
+ * @param pipe Pipe index
+ * @return flow
+ */
+double FlowState::getFlow(int pipe) const {
+    return flow[pipe];
+}
+
+/**
+ * @brief Sets the flow of a Pipe
+ * @param pipe Pipe index
+ * @param flow
+ */
+void FlowState::setFlow(int pipe, double flow) {
+    this->flow[pipe] = flow;
+}
+
+/**
+ * @brief Gets the flow of a Pipe
+ * @param e
+ * @return flow
+ */
+double FlowState::getFlow(const Pipe *e) const {
+    return flow[e->getIndex()];
+}
+
+/**
+ * @brief Returns the pressure of pipe (flow/capacity)
+ * @param e
+ * @return pressure
+ */
+float FlowState::getPressure(const Pipe *e) const {
+    return flow[e->getIndex()] / e->getCapacity();
+}
+
+/**
+ * @brief Gets the capacity cap of a Pipe while balancing
+ * @param pipe Pipe index
+ * @return capacity cap, INF if the Pipe is not capped
+ */
+double FlowState::getCapacityCap(int pipe) const {
+    return capacityCap[pipe];
+}
+
+/**
+ * @brief Caps the capacity of a Pipe while balancing
+ * @param e
+ * @param cap
+ */
+void FlowState::setCapacityCap(const Pipe *e, double cap) {
+    capacityCap[e->getIndex()] = cap;
+}
+
+/**
+ * @brief Checks if the ServicePoint was visited since the last clearVisited
+ * @param v ServicePoint index
+ * @return visited
+ */
+bool FlowState::isVisited(int v) const {
+    return visited[v] == epoch;
+}
+
+/**
+ * @brief Marks the ServicePoint as visited
+ * @param v ServicePoint index
+ */
+void FlowState::setVisited(int v) {
+    visited[v] = epoch;
+}
+
+/**
+ * @brief Gets the arc used to reach the ServicePoint
+ * @param v ServicePoint index
+ * @return arc index, -1 if none
+ */
+int FlowState::getPath(int v) const {
+    return path[v];
+}
+
+/**
+ * @brief Sets the arc used to reach the ServicePoint
+ * @param v ServicePoint index
+ * @param arc arc index
+ */
+void FlowState::setPath(int v, int arc) {
+    path[v] = arc;
+}
+
+/**
+ * @brief Gets the level of the ServicePoint in the level graph, -1 if it is not in it
+ * @param v ServicePoint index
+ * @return level
+ */
+int FlowState::getLevel(int v) const {
+    return level[v];
+}
+
+/**
+ * @brief Sets the level of the ServicePoint in the level graph
+ * @param v ServicePoint index
+ * @param level
+ */
+void FlowState::setLevel(int v, int level) {
+    this->level[v] = level;
+}
+
+/**
+ * @brief Gets the position, among the arcs of the ServicePoint, of the next arc to explore
+ * @param v ServicePoint index
+ * @return currentArc
+ */
+int FlowState::getCurrentArc(int v) const {
+    return currentArc[v];
+}
+
+/**
+ * @brief Sets the position, among the arcs of the ServicePoint, of the next arc to explore
+ * @param v ServicePoint index
+ * @param arc
+ */
+void FlowState::setCurrentArc(int v, int arc) {
+    currentArc[v] = arc;
+}
+
+/**
+ * @brief Gets the push-relabel height of the ServicePoint
+ * @param v ServicePoint index
+ * @return height
+ */
+int FlowState::getHeight(int v) const {
+    return height[v];
+}
+
+/**
+ * @brief Sets the push-relabel height of the ServicePoint
+ * @param v ServicePoint index
+ * @param height
+ */
+void FlowState::setHeight(int v, int height) {
+    this->height[v] = height;
+}
+
+/**
+ * @brief Gets the flow excess of the ServicePoint
+ * @param v ServicePoint index
+ * @return excess
+ */
+double FlowState::getExcess(int v) const {
+    return excess[v];
+}
+
+/**
+ * @brief Sets the flow excess of the ServicePoint
+ * @param v ServicePoint index
+ * @param excess
+ */
+void FlowState::setExcess(int v, double excess) {
+    this->excess[v] = excess;
+}
+
+/**
+ * @brief Checks if the ServicePoint was failed in this state
+ * @param v ServicePoint index
+ * @return failed
+ */
+bool FlowState::isServicePointFailed(int v) const {
+    return failedServicePoints[v];
+}
+
+/**
+ * @brief Fails a ServicePoint in this state only
+ * @param v ServicePoint index
+ * @param failed
+ */
+void FlowState::setServicePointFailed(int v, bool failed) {
+    failedServicePoints[v] = failed;
+}
+
+/**
+ * @brief Checks if the Pipe was failed in this state
+ * @param pipe Pipe index
+ * @return failed
+ */
+bool FlowState::isPipeFailed(int pipe) const {
+    return failedPipes[pipe];
+}
+
+/**
+ * @brief Fails a Pipe in this state only
+ * @param pipe Pipe index
+ * @param failed
+ */
+void FlowState::setPipeFailed(int pipe, bool failed) {
+    failedPipes[pipe] = failed;
+}
+
+/**
+ * @brief Counts one augmenting path or push applied to the flow
+ */
+void FlowState::countAugmentation() {
+    augmentations++;
+    SOLVER_COUNT(*this, augmentations, 1);
+}
+
+/**
+ * @brief Adds the augmentations done in another FlowState, such as the one of a worker
+ * @param count
+ */
+void FlowState::addAugmentations(unsigned long count) {
+    augmentations += count;
+}
+
+/**
+ * @brief Gets the number of augmenting paths and pushes applied since the FlowState was created. It is not reset
+ * between solves, so the work of one query is the difference before and after it
+ * @return augmentations
+ */
+unsigned long FlowState::getAugmentations() const {
+    return augmentations;
+}
+
+/**
+ * @brief Gets the work counters and phase times of the solves done in the FlowState
+ * @return stats
+ */
+SolverStats & FlowState::getStats() {
+    return stats;
+}
+
+const SolverStats & FlowState::getStats() const {
+    return stats;
+}
+
+/**
+ * @brief Gets the bytes of the FlowState
+ * @return bytes
+ */
+std::size_t FlowState::getMemoryUsage() const {
+    return sizeof(FlowState) + MemoryReport::vectorBytes(flow) + MemoryReport::vectorBytes(capacityCap)
+            + MemoryReport::vectorBytes(failedPipes) + MemoryReport::vectorBytes(path)
+            + MemoryReport::vectorBytes(visited) + MemoryReport::vectorBytes(level)
+            + MemoryReport::vectorBytes(currentArc) + MemoryReport::vectorBytes(height)
+            + MemoryReport::vectorBytes(excess) + MemoryReport::vectorBytes(failedServicePoints)
+            + MemoryReport::vectorBytes(queue);
+}
@@ -0,0 +1,82 @@
+#ifndef PROJECT1_FLOWSTATE_H
+#define PROJECT1_FLOWSTATE_H
+
+#include <vector>
+#include "ResidualGraph.h"
+#include "SolverStats.h"
+
+/**
+ * @brief Mutable state of one max flow solve, indexed by the ServicePoint and Pipe indexes of a ResidualGraph.
+ * @details The Graph is only read, so several solves, each with its own FlowState, can run over it at the same time and
+ * several results (baseline, scenarios) can be kept at once. Elements can also be failed in the FlowState only,
+ * without touching the shared Graph.
+ */
+class FlowState {
+public:
+    FlowState(const ResidualGraph &r);
+
+    void resize(const ResidualGraph &r);
+    void reset();
+    void clearVisited();
+    void clearLevels();
+    void clearCapacityCaps();
+    std::vector<int> & getQueue();
+
+    // Pipes
+    double getFlow(int pipe) const;
+    void setFlow(int pipe, double flow);
+    double getFlow(const Pipe *e) const;
+    float getPressure(const Pipe *e) const;
+    double getCapacityCap(int pipe) const;
+    void setCapacityCap(const Pipe *e, double cap);
+
+    // ServicePoints
+    bool isVisited(int v) const;
+    void setVisited(int v);
+    int getPath(int v) const;
+    void setPath(int v, int arc);
+    int getLevel(int v) const;
+    void setLevel(int v, int level);
+    int getCurrentArc(int v) const;
+    void setCurrentArc(int v, int arc);
+    int getHeight(int v) const;
+    void setHeight(int v, int height);
+    double getExcess(int v) const;
+    void setExcess(int v, double excess);
+
+    // Failures
+    bool isServicePointFailed(int v) const;
+    void setServicePointFailed(int v, bool failed);
+    bool isPipeFailed(int pipe) const;
+    void setPipeFailed(int pipe, bool failed);
+
+    // Work done
+    void countAugmentation();
+    void addAugmentations(unsigned long count);
+    unsigned long getAugmentations() const;
+    SolverStats & getStats();
+    const SolverStats & getStats() const;
+
+    std::size_t getMemoryUsage() const;
+
+private:
+    // Pipe state
+    std::vector<double> flow;
+    std::vector<double> capacityCap; // capacity limit while balancing, INF if none
+    std::vector<char> failedPipes;
+
+    // ServicePoint state
+    std::vector<int> path; // arc used to reach each ServicePoint, -1 if none
+    std::vector<unsigned> visited; // ServicePoints visited in the current search hold the current epoch
+    unsigned epoch = 1;
+    std::vector<int> level; // distance from the source in the level graph
+    std::vector<int> currentArc; // position of the next arc to try in a blocking flow or discharge
+    std::vector<int> height; // push-relabel distance label
+    std::vector<double> excess; // push-relabel flow excess
+    std::vector<char> failedServicePoints;
+    std::vector<int> queue; // reused by the searches, so they do not allocate
+    unsigned long augmentations = 0; // augmenting paths and pushes applied since the FlowState was created
+    SolverStats stats;
+};
+
+#endif //PROJECT1_FLOWSTATE_H
@@ -1,18 +1,84 @@
 #include <iostream>
 #include <algorithm>
+#include <cctype>
+#include <stdexcept>
 #include "Graph.h"
 
+/**
+ * @brief Removes an element from a set by moving the last element into its slot
+ * @param set - set holding the element
+ * @param position - position in the set of each index, kept up to date
+ * @param element
+ * @details Time Complexity O(1)
+ */
+template <typename T>
+static void swapAndPop(std::vector<T *> &set, std::vector<int> &position, T *element) {
+    int slot = position[element->getIndex()];
+    T *last = set.back();
+    set[slot] = last;
+    position[last->getIndex()] = slot;
+    set.pop_back();
+    position[element->getIndex()] = -1;
+}
+
+/**
+ * @brief Puts an element back at the slot it was removed from, undoing swapAndPop. The element in that slot moves back
+ * to the end of the set
+ * @param set - set that held the element
+ * @param position - position in the set of each index, kept up to date
+ * @param element
+ * @param slot - position of the element before it was removed
+ * @details Time Complexity O(1) amortized
+ */
+template <typename T>
+static void restoreToSlot(std::vector<T *> &set, std::vector<int> &position, T *element, int slot) {
+    if (slot < (int) set.size()) {
+        T *moved = set[slot];
+        position[moved->getIndex()] = (int) set.size();
+        set.push_back(moved);
+        set[slot] = element;
+    } else {
+        set.push_back(element);
+    }
+    position[element->getIndex()] = slot;
+}
+
+/**
+ * @brief Stores a ServicePoint in a table indexed by symbol id, unless another one already has that id
+ * @param table
+ * @param symbol
+ * @param servicePoint
+ * @details Time Complexity O(1) amortized
+ */
+static void storeBySymbol(std::vector<ServicePoint *> &table, uint32_t symbol, ServicePoint *servicePoint) {
+    if (symbol >= table.size())
+        table.resize(symbol + 1, nullptr);
+    if (table[symbol] == nullptr)
+        table[symbol] = servicePoint;
+}
+
+/**
+ * @brief Clears the entry of a ServicePoint in a table indexed by symbol id
+ * @param table
+ * @param symbol
+ * @param servicePoint
+ */
+static void eraseBySymbol(std::vector<ServicePoint *> &table, uint32_t symbol, ServicePoint *servicePoint) {
+    if (symbol < table.size() && table[symbol] == servicePoint)
+        table[symbol] = nullptr;
+}
+
 /**
  * @brief Graph Destructor
- * @details Time Complexity O(S) S = number of ServicePoints
+ * @details Time Complexity O(S+P) S = number of ServicePoints, P = number of Pipes
  */
 Graph::~Graph() {
-    auto it = servicePointSet.begin();
-    while (it != servicePointSet.end()) {
-        ServicePoint *sp = *it;
-        it++;
-        removeServicePoint(sp);
-    }
+    for (const GraphEdit &edit : journal)
+        release(edit);
+    for (Pipe *pipe : pipeSet)
+        delete pipe;
+    for (ServicePoint *servicePoint : servicePointSet)
+        delete servicePoint;
 }
 
 /**
@@ -21,8 +87,9 @@ Graph::~Graph() {
  */
 void Graph::addReservoir(Reservoir *pReservoir) {
     addServicePoint(pReservoir);
+    groupPosition[pReservoir->getIndex()] = (int) reservoirSet.size();
     reservoirSet.push_back(pReservoir);
-    reservoirByName.insert(make_pair(pReservoir->getName(), pReservoir));
+    storeBySymbol(reservoirByName, names.intern(pReservoir->getName()), pReservoir);
 
 }
 
@@ -41,171 +108,725 @@ void Graph::addStation(Station *pStation) {
  */
 void Graph::addCity(City *pCity) {
     addServicePoint(pCity);
+    groupPosition[pCity->getIndex()] = (int) citySet.size();
     citySet.push_back(pCity);
-    cityByName.insert(make_pair(pCity->getName(), pCity));
+    storeBySymbol(cityByName, names.intern(pCity->getName()), pCity);
 }
 
 /**
  * @brief Adds a ServicePoint to the Graph
  * @param servicePoint
+ * @throws std::logic_error if another ServicePoint already has its code. The ServicePoint is then not added and stays
+ * owned by the caller
  */
 void Graph::addServicePoint(ServicePoint *servicePoint) {
+    if (getServicePointBySymbol(codes.find(servicePoint->getCode())) != nullptr)
+        throw std::logic_error("Duplicate service point code " + servicePoint->getCode());
+    GraphEdit edit{GraphEdit::ADD_SERVICE_POINT};
+    edit.servicePoint = servicePoint;
+    edit.freshIndex = freeServicePointIndexes.empty();
+    servicePoint->setIndex(takeServicePointIndex());
+    record(edit);
+    version = ++lastVersion;
+    servicePointPosition[servicePoint->getIndex()] = (int) servicePointSet.size();
     servicePointSet.push_back(servicePoint);
-    servicePointByCode.insert(make_pair(servicePoint->getCode(), servicePoint));
+    servicePoint->setSymbol(codes.intern(servicePoint->getCode()));
+    storeBySymbol(servicePointBySymbol, servicePoint->getSymbol(), servicePoint);
 }
 
 /**
- * @brief Removes a Service Point from the Graph
+ * @brief Removes a Service Point from the Graph. The last ServicePoint of each set takes its position, and its index
+ * is given to the next ServicePoint added. Inside a transaction, the ServicePoint and its index are kept until the
+ * outermost transaction commits
  * @param servicePoint
- * @details Time Complexity O(P²) P = number of Pipes
+ * @details Time Complexity O(d) d = number of Pipes of the ServicePoint
  */
 void Graph::removeServicePoint(ServicePoint *servicePoint) {
     removeAssociatedPipes(servicePoint);
-    servicePointByCode.erase(servicePoint->getCode());
-    servicePointSet.erase(std::find(servicePointSet.begin(), servicePointSet.end(), servicePoint));
+    version = ++lastVersion;
+    GraphEdit edit{GraphEdit::REMOVE_SERVICE_POINT};
+    edit.servicePoint = servicePoint;
+    edit.slot = servicePointPosition[servicePoint->getIndex()];
+    edit.groupSlot = groupPosition[servicePoint->getIndex()];
+    eraseBySymbol(servicePointBySymbol, servicePoint->getSymbol(), servicePoint);
+    swapAndPop(servicePointSet, servicePointPosition, servicePoint);
     City * c = dynamic_cast<City *> (servicePoint);
     Reservoir * r = dynamic_cast<Reservoir *> (servicePoint);
-    Station * s = dynamic_cast<Station *> (servicePoint);
     if (c != nullptr) {
-        citySet.erase(std::find(citySet.begin(), citySet.end(), servicePoint));
-        cityByName.erase(c->getName());
+        swapAndPop(citySet, groupPosition, servicePoint);
+        eraseBySymbol(cityByName, names.find(c->getName()), servicePoint);
     } else if (r != nullptr) {
-        reservoirSet.erase(std::find(reservoirSet.begin(), reservoirSet.end(), servicePoint));
-        reservoirByName.erase(r->getName());
+        swapAndPop(reservoirSet, groupPosition, servicePoint);
+        eraseBySymbol(reservoirByName, names.find(r->getName()), servicePoint);
     }
-    delete servicePoint;
+    if (inTransaction())
+        record(edit);
+    else
+        release(edit);
 }
 
 /**
  * @brief Removes associated Pipes to a given Service Point
  * @param servicePoint
- * @details Time Complexity O(P²) P = bigger number of adjacent or incoming Pipes
+ * @details Time Complexity O(d) d = number of Pipes of the ServicePoint
  */
 void Graph::removeAssociatedPipes(ServicePoint * servicePoint) {
-    for (Pipe * pipe : servicePoint->getAdj()) {
-        removePipe(pipe);
+    // Each removal shrinks the lists, so always remove the last Pipe left
+    while (!servicePoint->getAdj().empty()) {
+        removePipe(servicePoint->getAdj().back());
     }
-    for (Pipe * pipe : servicePoint->getIncoming()) {
-        removePipe(pipe);
+    while (!servicePoint->getIncoming().empty()) {
+        removePipe(servicePoint->getIncoming().back());
     }
 }
 
 /**
  * @brief Adds a Pipe to the Graph
- * @param spA
- * @param spB
+ * @param spA code of the origin
+ * @param spB code of the destination
+ * @param capacity
+ * @details Throws a logic_error if a code does not belong to a ServicePoint of the Graph
+ */
+void Graph::addPipe(const std::string &spA, const std::string &spB, int capacity) {
+    addPipe(codes.find(spA), codes.find(spB), capacity);
+}
+
+/**
+ * @brief Adds a Pipe to the Graph
+ * @param spA code id of the origin
+ * @param spB code id of the destination
  * @param capacity
+ * @details Throws a logic_error if an id does not belong to a ServicePoint of the Graph
  */
-void Graph::addPipe(std::string spA, std::string spB, int capacity) {
-    Pipe *pPipe = new Pipe(servicePointByCode[spA], servicePointByCode[spB], capacity);
-    pPipe->getOrig()->addPipe(pPipe);
-    pPipe->getDest()->addIncomingPipe(pPipe);
-    pipeSet.push_back(pPipe);
-    pipeByEnds[std::make_pair(spA,spB)] = {pPipe};
+void Graph::addPipe(uint32_t spA, uint32_t spB, int capacity) {
+    newPipe(requireServicePoint(spA), requireServicePoint(spB), capacity);
+    version = ++lastVersion;
 }
 
 /**
  * @brief Adds a Bidirectional Pipe to the Graph
- * @param spA
- * @param spB
+ * @param spA code of one end
+ * @param spB code of the other end
  * @param capacity
+ * @details Throws a logic_error if a code does not belong to a ServicePoint of the Graph
  */
-void Graph::addBidirectionalPipe(std::string spA, std::string spB, int capacity) {
-    Pipe *pPipe1 = new Pipe(servicePointByCode[spA], servicePointByCode[spB], capacity);
-    Pipe *pPipe2 = new Pipe(servicePointByCode[spB], servicePointByCode[spA], capacity);
-    pPipe1->getOrig()->addPipe(pPipe1);
-    pPipe1->getDest()->addIncomingPipe(pPipe1);
-    pPipe2->getOrig()->addPipe(pPipe2);
-    pPipe2->getDest()->addIncomingPipe(pPipe2);
+void Graph::addBidirectionalPipe(const std::string &spA, const std::string &spB, int capacity) {
+    addBidirectionalPipe(codes.find(spA), codes.find(spB), capacity);
+}
+
+/**
+ * @brief Adds a Bidirectional Pipe to the Graph
+ * @param spA code id of one end
+ * @param spB code id of the other end
+ * @param capacity
+ * @details Throws a logic_error if an id does not belong to a ServicePoint of the Graph
+ */
+void Graph::addBidirectionalPipe(uint32_t spA, uint32_t spB, int capacity) {
+    ServicePoint *a = requireServicePoint(spA);
+    ServicePoint *b = requireServicePoint(spB);
+    Pipe *pPipe1 = newPipe(a, b, capacity);
+    Pipe *pPipe2 = newPipe(b, a, capacity);
+    version = ++lastVersion;
     pPipe1->setReverse(pPipe2);
     pPipe2->setReverse(pPipe1);
-    pipeSet.push_back(pPipe1);
-    pipeSet.push_back(pPipe2);
-    pipeByEnds[std::make_pair(spA,spB)] = {pPipe1};
-    pipeByEnds[std::make_pair(spB,spA)] = {pPipe2};
 }
 
 /**
- * @brief Removes a Pipe from the Graph
+ * @brief Creates a Pipe and links it to its ends, to the Pipe set and to the lookup by ends
+ * @param orig
+ * @param dest
+ * @param capacity
+ * @return Pipe
+ */
+Pipe * Graph::newPipe(ServicePoint *orig, ServicePoint *dest, int capacity) {
+    Pipe *pipe = new Pipe(orig, dest, capacity);
+    GraphEdit edit{GraphEdit::ADD_PIPE};
+    edit.pipe = pipe;
+    edit.freshIndex = freePipeIndexes.empty();
+    pipe->setIndex(takePipeIndex());
+    orig->addPipe(pipe);
+    dest->addIncomingPipe(pipe);
+    pipePosition[pipe->getIndex()] = (int) pipeSet.size();
+    pipeSet.push_back(pipe);
+    uint64_t key = FlatHashMap<Pipe *>::key(orig->getSymbol(), dest->getSymbol());
+    if (Pipe **found = pipeByEnds.find(key))
+        edit.replaced = *found;
+    pipeByEnds.insert(key, pipe);
+    record(edit);
+    return pipe;
+}
+
+/**
+ * @brief Gets the ServicePoint of a code id, which must be in the Graph
+ * @param symbol
+ * @return ServicePoint
+ */
+ServicePoint * Graph::requireServicePoint(uint32_t symbol) const {
+    ServicePoint *servicePoint = getServicePointBySymbol(symbol);
+    if (servicePoint == nullptr) {
+        throw std::logic_error("Pipe end is not a ServicePoint of the Graph");
+    }
+    return servicePoint;
+}
+
+/**
+ * @brief Removes a Pipe from the Graph, along with its reverse Pipe. The last Pipe of each list takes its position,
+ * and its index is given to the next Pipe added. Inside a transaction, the Pipes and their indexes are kept until the
+ * outermost transaction commits
  * @param pipe
- * @details Time Complexity O(P) P = number of Pipes
+ * @details Time Complexity O(1)
  */
 void Graph::removePipe(Pipe * pipe) {
+    version = ++lastVersion;
+    if (pipe->getReverse() != nullptr)
+        detachPipe(pipe->getReverse());
+    detachPipe(pipe);
+}
+
+/**
+ * @brief Unlinks a single Pipe from its ends, from the Pipe set and from the lookup by ends, then frees it or, inside
+ * a transaction, records it to be restored or freed later
+ * @param pipe
+ * @details Time Complexity O(1)
+ */
+void Graph::detachPipe(Pipe *pipe) {
+    GraphEdit edit{GraphEdit::REMOVE_PIPE};
+    edit.pipe = pipe;
+    edit.slot = pipePosition[pipe->getIndex()];
+    edit.adjSlot = pipe->getAdjPosition();
+    edit.incomingSlot = pipe->getIncomingPosition();
     pipe->getOrig()->removeOutgoingPipe(pipe);
     pipe->getDest()->removeIncomingPipe(pipe);
-    if (pipe->getReverse() != nullptr) {
-        pipe->getReverse()->getOrig()->removeOutgoingPipe(pipe->getReverse());
-        pipe->getReverse()->getDest()->removeIncomingPipe(pipe->getReverse());
-        pipeSet.erase(std::find(pipeSet.begin(), pipeSet.end(), pipe->getReverse()));
-        pipeByEnds.erase(std::make_pair(pipe->getDest()->getCode(),pipe->getOrig()->getCode()));
-        delete pipe->getReverse();
+    swapAndPop(pipeSet, pipePosition, pipe);
+    eraseByEnds(pipe);
+    if (inTransaction())
+        record(edit);
+    else
+        release(edit);
+}
+
+/**
+ * @brief Sets the capacity of a Pipe of the Graph, along with its reverse Pipe
+ * @param pipe
+ * @param capacity
+ * @details Time Complexity O(1)
+ */
+void Graph::setPipeCapacity(Pipe * pipe, int capacity) {
+    if (capacity < 0) {
+        throw std::logic_error("Pipe capacity cannot be negative");
+    }
+    version = ++lastVersion;
+    for (Pipe *e : {pipe, pipe->getReverse()}) {
+        if (e == nullptr)
+            continue;
+        GraphEdit edit{GraphEdit::SET_CAPACITY};
+        edit.pipe = e;
+        edit.capacity = e->getCapacity();
+        record(edit);
+        e->setCapacity(capacity);
+    }
+}
+
+/**
+ * @brief Puts a ServicePoint of the Graph in or out of operation
+ * @param servicePoint
+ * @param operational
+ * @details Time Complexity O(1)
+ */
+void Graph::setOperational(ServicePoint * servicePoint, bool operational) {
+    version = ++lastVersion;
+    GraphEdit edit{GraphEdit::SET_SERVICE_POINT_OPERATIONAL};
+    edit.servicePoint = servicePoint;
+    edit.operational = servicePoint->isOperational();
+    record(edit);
+    servicePoint->setOperational(operational);
+}
+
+/**
+ * @brief Puts a Pipe of the Graph in or out of operation, along with its reverse Pipe
+ * @param pipe
+ * @param operational
+ * @details Time Complexity O(1)
+ */
+void Graph::setOperational(Pipe * pipe, bool operational) {
+    version = ++lastVersion;
+    for (Pipe *e : {pipe, pipe->getReverse()}) {
+        if (e == nullptr)
+            continue;
+        GraphEdit edit{GraphEdit::SET_PIPE_OPERATIONAL};
+        edit.pipe = e;
+        edit.operational = e->isOperational();
+        record(edit);
+        e->setOperational(operational);
+    }
+}
+
+/**
+ * @brief Makes room for more ServicePoints, so that adding them does not grow the sets one step at a time
+ * @param additional number of ServicePoints about to be added
+ */
+void Graph::reserveServicePoints(std::size_t additional) {
+    std::size_t total = servicePointSet.size() + additional;
+    servicePointSet.reserve(total);
+    servicePointPosition.reserve(total);
+    groupPosition.reserve(total);
+    servicePointBySymbol.reserve(total);
+}
+
+/**
+ * @brief Makes room for more Pipes, so that adding them does not grow or rehash the sets one step at a time
+ * @param additional number of Pipes about to be added
+ */
+void Graph::reservePipes(std::size_t additional) {
+    std::size_t total = pipeSet.size() + additional;
+    pipeSet.reserve(total);
+    pipePosition.reserve(total);
+    pipeByEnds.reserve(total);
+}
+
+/**
+ * @brief Removes a Pipe from the lookup by ends, unless a later Pipe with the same ends replaced it there
+ * @param pipe
+ */
+void Graph::eraseByEnds(Pipe *pipe) {
+    uint64_t key = FlatHashMap<Pipe *>::key(pipe->getOrig()->getSymbol(), pipe->getDest()->getSymbol());
+    Pipe **found = pipeByEnds.find(key);
+    if (found != nullptr && *found == pipe)
+        pipeByEnds.erase(key);
+}
+
+/**
+ * @brief Gives an index to a new ServicePoint, reusing the index of a removed one if there is any
+ * @return index
+ * @details Time Complexity O(1) amortized
+ */
+int Graph::takeServicePointIndex() {
+    if (!freeServicePointIndexes.empty()) {
+        int index = freeServicePointIndexes.back();
+        freeServicePointIndexes.pop_back();
+        return index;
+    }
+    servicePointPosition.push_back(-1);
+    groupPosition.push_back(-1);
+    return nextServicePointIndex++;
+}
+
+/**
+ * @brief Gives an index to a new Pipe, reusing the index of a removed one if there is any
+ * @return index
+ * @details Time Complexity O(1) amortized
+ */
+int Graph::takePipeIndex() {
+    if (!freePipeIndexes.empty()) {
+        int index = freePipeIndexes.back();
+        freePipeIndexes.pop_back();
+        return index;
     }
-    pipeSet.erase(std::find(pipeSet.begin(), pipeSet.end(), pipe));
-    pipeByEnds.erase(std::make_pair(pipe->getOrig()->getCode(),pipe->getDest()->getCode()));
-    delete pipe;
+    pipePosition.push_back(-1);
+    return nextPipeIndex++;
 }
 
 /**
- * @brief Gets the ServicePoint set
+ * @brief Gets the ServicePoint set, without copying it. Elements are kept in insertion order until one is removed, which
+ * moves the last element into its slot
  * @return servicePointSet
  */
-std::vector<ServicePoint *> Graph::getServicePointSet() const {
+Span<ServicePoint *> Graph::getServicePointSet() const {
     return servicePointSet;
 }
 
 /**
- * @brief Gets the Reservoir set
+ * @brief Gets the Reservoir set, without copying it. Elements are kept in insertion order until one is removed, which
+ * moves the last element into its slot
  * @return reservoirSet
  */
-std::vector<ServicePoint *> Graph::getReservoirSet() const{
+Span<ServicePoint *> Graph::getReservoirSet() const {
     return reservoirSet;
 }
 
 /**
- * @brief Gets the Cities set
+ * @brief Gets the Cities set, without copying it. Elements are kept in insertion order until one is removed, which
+ * moves the last element into its slot
  * @return citySet
  */
-std::vector<ServicePoint *> Graph::getCitiesSet() const{
+Span<ServicePoint *> Graph::getCitiesSet() const {
     return citySet;
 }
 
 /**
- * @brief Gets the Pipe set
+ * @brief Gets the Pipe set, without copying it. Elements are kept in insertion order until one is removed, which
+ * moves the last element into its slot
  * @return pipeSet
  */
-std::vector<Pipe *> Graph::getPipeSet() const{
+Span<Pipe *> Graph::getPipeSet() const {
     return pipeSet;
 }
 
+/**
+ * @brief Gets the Cities sorted by code, an order that does not change when other ServicePoints are removed
+ * @return cities
+ * @details Time Complexity O(C log C), C = number of Cities
+ */
+std::vector<ServicePoint *> Graph::getCitiesByCode() const {
+    std::vector<ServicePoint *> cities(citySet.begin(), citySet.end());
+    std::sort(cities.begin(), cities.end(), [](ServicePoint *a, ServicePoint *b) {
+        return codeLess(a->getCode(), b->getCode());
+    });
+    return cities;
+}
+
+/**
+ * @brief Compares two codes in natural order: by the text before the trailing number, then by that number, so that
+ * C_2 comes before C_10
+ * @param a
+ * @param b
+ * @return true if a comes before b
+ * @details Time Complexity O(L), L = length of the codes
+ */
+bool Graph::codeLess(const std::string &a, const std::string &b) {
+    auto digitsFrom = [](const std::string &code) {
+        std::size_t start = code.size();
+        while (start > 0 && std::isdigit((unsigned char) code[start - 1]))
+            start--;
+        return start;
+    };
+    auto significantFrom = [](const std::string &code, std::size_t start) {
+        while (start + 1 < code.size() && code[start] == '0')
+            start++;
+        return start;
+    };
+    std::size_t i = digitsFrom(a), j = digitsFrom(b);
+    int prefix = a.compare(0, i, b, 0, j);
+    if (prefix != 0)
+        return prefix < 0;
+    i = significantFrom(a, i);
+    j = significantFrom(b, j);
+    if (a.size() - i != b.size() - j)
+        return a.size() - i < b.size() - j;
+    int number = a.compare(i, std::string::npos, b, j, std::string::npos);
+    if (number != 0)
+        return number < 0;
+    return a < b;
+}
+
+/**
+ * @brief Gets the upper bound of the ServicePoint indexes, to size arrays indexed by them
+ * @return bound
+ */
+int Graph::getServicePointIndexBound() const {
+    return nextServicePointIndex;
+}
+
+/**
+ * @brief Gets the upper bound of the Pipe indexes, to size arrays indexed by them
+ * @return bound
+ */
+int Graph::getPipeIndexBound() const {
+    return nextPipeIndex;
+}
+
+/**
+ * @brief Gets the version of the network, which changes whenever a ServicePoint or Pipe is added or removed, a Pipe
+ * capacity changes or an element is put in or out of operation through the Graph. A rollback brings back the version
+ * of the network it restores, and a change never reuses a version given before
+ * @return version
+ */
+unsigned long Graph::getVersion() const {
+    return version;
+}
+
+/**
+ * @brief Gets the ServicePoint with a given index, which stays the same while the ServicePoint is in the Graph
+ * @param index
+ * @return ServicePoint, nullptr if no ServicePoint has the index
+ * @details Time Complexity O(1)
+ */
+ServicePoint * Graph::getServicePoint(int index) const {
+    if (index < 0 || index >= nextServicePointIndex || servicePointPosition[index] == -1)
+        return nullptr;
+    return servicePointSet[servicePointPosition[index]];
+}
+
+/**
+ * @brief Gets the Pipe with a given index, which stays the same while the Pipe is in the Graph
+ * @param index
+ * @return Pipe, nullptr if no Pipe has the index
+ * @details Time Complexity O(1)
+ */
+Pipe * Graph::getPipe(int index) const {
+    if (index < 0 || index >= nextPipeIndex || pipePosition[index] == -1)
+        return nullptr;
+    return pipeSet[pipePosition[index]];
+}
+
+/**
+ * @brief Gets the id of a ServicePoint code, to use with the lookups by id
+ * @param code
+ * @return id, SymbolTable::NONE if no ServicePoint ever had the code
+ */
+uint32_t Graph::getSymbol(std::string_view code) const {
+    return codes.find(code);
+}
+
+/**
+ * @brief Gets the ServicePoint by code id
+ * @param symbol
+ * @return ServicePoint, nullptr if none has the code
+ * @details Time Complexity O(1)
+ */
+ServicePoint * Graph::getServicePointBySymbol(uint32_t symbol) const {
+    return symbol < servicePointBySymbol.size() ? servicePointBySymbol[symbol] : nullptr;
+}
+
+/**
+ * @brief Gets the Pipe by the code ids of its ends
+ * @param orig
+ * @param dest
+ * @return Pipe, nullptr if there is none
+ * @details Time Complexity O(1) on average
+ */
+Pipe * Graph::getPipeBySymbols(uint32_t orig, uint32_t dest) const {
+    if (orig == SymbolTable::NONE || dest == SymbolTable::NONE)
+        return nullptr;
+    Pipe * const *pipe = pipeByEnds.find(FlatHashMap<Pipe *>::key(orig, dest));
+    return pipe == nullptr ? nullptr : *pipe;
+}
+
 /**
  * @brief Gets the City by name
  * @param name
+ * @return City, nullptr if none has the name
  */
-ServicePoint * Graph::getCityByName(const std::string &name){
-    return cityByName[name];
+ServicePoint * Graph::getCityByName(const std::string &name) const {
+    uint32_t symbol = names.find(name);
+    return symbol < cityByName.size() ? cityByName[symbol] : nullptr;
 }
 
 /**
  * @brief Gets the Reservoir by name
  * @param name
+ * @return Reservoir, nullptr if none has the name
  */
-ServicePoint * Graph::getReservoirByName(const std::string &name){
-    return reservoirByName[name];
+ServicePoint * Graph::getReservoirByName(const std::string &name) const {
+    uint32_t symbol = names.find(name);
+    return symbol < reservoirByName.size() ? reservoirByName[symbol] : nullptr;
 }
 
 /**
  * @brief Gets the ServicePoint by code
  * @param code
+ * @return ServicePoint, nullptr if none has the code
  */
-ServicePoint * Graph::findServicePoint(const std::string &code) {
-    return servicePointByCode[code];
+ServicePoint * Graph::findServicePoint(const std::string &code) const {
+    return getServicePointBySymbol(codes.find(code));
 }
 
 /**
  * @brief Gets the Pipe by its ends
- * @param orig
- * @param dest
+ * @param orig code of the origin
+ * @param dest code of the destination
+ * @return Pipe, nullptr if there is none
+ */
+Pipe * Graph::getPipeByEnds(const std::string &orig, const std::string &dest) const {
+    return getPipeBySymbols(codes.find(orig), codes.find(dest));
+}
+
+/**
+ * @brief Opens a transaction, inside which every change to the Graph is recorded so that it can be undone. Transactions
+ * nest, and must be closed innermost first
+ * @return mark of the transaction, to commit or roll it back
+ * @details Time Complexity O(1)
+ */
+std::size_t Graph::beginTransaction() {
+    transactionMarks.push_back(journal.size());
+    transactionVersions.push_back(version);
+    return journal.size();
+}
+
+/**
+ * @brief Keeps the changes of the innermost transaction. Inside another transaction they can still be rolled back with
+ * it, otherwise the ServicePoints and Pipes removed are freed and their indexes given to the next ones added
+ * @param mark mark of the innermost transaction
+ * @details Throws a logic_error if the mark is not the one of the innermost transaction.
+ * Time Complexity O(1), O(E) for the outermost transaction, E = number of changes
+ */
+void Graph::commitTransaction(std::size_t mark) {
+    if (transactionMarks.empty() || transactionMarks.back() != mark) {
+        throw std::logic_error("Only the innermost transaction can be committed");
+    }
+    transactionMarks.pop_back();
+    transactionVersions.pop_back();
+    if (!transactionMarks.empty())
+        return;
+    for (const GraphEdit &edit : journal)
+        release(edit);
+    journal.clear();
+}
+
+/**
+ * @brief Undoes every change of the innermost transaction, latest first, leaving the sets, adjacency lists, indexes
+ * and version exactly as they were when it began, so that snapshots and results of that version are valid again.
+ * Pointers to ServicePoints and Pipes added inside it are no longer valid
+ * @param mark mark of the innermost transaction
+ * @details Throws a logic_error if the mark is not the one of the innermost transaction.
+ * Time Complexity O(E), E = number of changes of the transaction
+ */
+void Graph::rollbackTransaction(std::size_t mark) {
+    if (transactionMarks.empty() || transactionMarks.back() != mark) {
+        throw std::logic_error("Only the innermost transaction can be rolled back");
+    }
+    transactionMarks.pop_back();
+    while (journal.size() > mark) {
+        undo(journal.back());
+        journal.pop_back();
+    }
+    version = transactionVersions.back();
+    transactionVersions.pop_back();
+}
+
+/**
+ * @brief Checks if a transaction is open
+ * @return true if changes are being recorded
  */
-Pipe * Graph::getPipeByEnds(std::string orig, std::string dest){
-    return pipeByEnds[std::make_pair(orig,dest)];
+bool Graph::inTransaction() const {
+    return !transactionMarks.empty();
+}
+
+/**
+ * @brief Gets the changes recorded since the outermost open transaction began, oldest first
+ * @return journal
+ */
+const std::vector<GraphEdit> & Graph::getJournal() const {
+    return journal;
+}
+
+/**
+ * @brief Adds the bytes of the network to a report: the ServicePoints and Pipes, their Pipe lists, their strings and
+ * every set and lookup of the Graph
+ * @param report
+ * @details Time Complexity O(S+P), S = number of ServicePoints, P = number of Pipes
+ */
+void Graph::addMemoryUsage(MemoryReport &report) const {
+    for (ServicePoint *v : servicePointSet)
+        v->addMemoryUsage(report);
+    report.pipes += pipeSet.size() * sizeof(Pipe);
+    codes.addMemoryUsage(report);
+    names.addMemoryUsage(report);
+    report.indexes += MemoryReport::vectorBytes(servicePointSet) + MemoryReport::vectorBytes(reservoirSet)
+            + MemoryReport::vectorBytes(citySet) + MemoryReport::vectorBytes(pipeSet)
+            + MemoryReport::vectorBytes(servicePointBySymbol) + MemoryReport::vectorBytes(cityByName)
+            + MemoryReport::vectorBytes(reservoirByName) + pipeByEnds.getMemoryUsage()
+            + MemoryReport::vectorBytes(freeServicePointIndexes) + MemoryReport::vectorBytes(freePipeIndexes)
+            + MemoryReport::vectorBytes(servicePointPosition) + MemoryReport::vectorBytes(groupPosition)
+            + MemoryReport::vectorBytes(pipePosition) + MemoryReport::vectorBytes(journal)
+            + MemoryReport::vectorBytes(transactionMarks) + MemoryReport::vectorBytes(transactionVersions);
+}
+
+/**
+ * @brief Records a change in the journal, if a transaction is open
+ * @param edit
+ */
+void Graph::record(const GraphEdit &edit) {
+    if (inTransaction())
+        journal.push_back(edit);
+}
+
+/**
+ * @brief Undoes one change. Every later change must have been undone first
+ * @param edit
+ * @details Time Complexity O(1) amortized
+ */
+void Graph::undo(const GraphEdit &edit) {
+    switch (edit.kind) {
+        case GraphEdit::ADD_SERVICE_POINT: {
+            ServicePoint *servicePoint = edit.servicePoint;
+            City * c = dynamic_cast<City *> (servicePoint);
+            Reservoir * r = dynamic_cast<Reservoir *> (servicePoint);
+            if (c != nullptr) {
+                swapAndPop(citySet, groupPosition, servicePoint);
+                eraseBySymbol(cityByName, names.find(c->getName()), servicePoint);
+            } else if (r != nullptr) {
+                swapAndPop(reservoirSet, groupPosition, servicePoint);
+                eraseBySymbol(reservoirByName, names.find(r->getName()), servicePoint);
+            }
+            eraseBySymbol(servicePointBySymbol, servicePoint->getSymbol(), servicePoint);
+            swapAndPop(servicePointSet, servicePointPosition, servicePoint);
+            if (edit.freshIndex) {
+                nextServicePointIndex--;
+                servicePointPosition.pop_back();
+                groupPosition.pop_back();
+            } else {
+                freeServicePointIndexes.push_back(servicePoint->getIndex());
+            }
+            delete servicePoint;
+            break;
+        }
+        case GraphEdit::REMOVE_SERVICE_POINT: {
+            ServicePoint *servicePoint = edit.servicePoint;
+            restoreToSlot(servicePointSet, servicePointPosition, servicePoint, edit.slot);
+            storeBySymbol(servicePointBySymbol, servicePoint->getSymbol(), servicePoint);
+            City * c = dynamic_cast<City *> (servicePoint);
+            Reservoir * r = dynamic_cast<Reservoir *> (servicePoint);
+            if (c != nullptr) {
+                restoreToSlot(citySet, groupPosition, servicePoint, edit.groupSlot);
+                storeBySymbol(cityByName, names.find(c->getName()), servicePoint);
+            } else if (r != nullptr) {
+                restoreToSlot(reservoirSet, groupPosition, servicePoint, edit.groupSlot);
+                storeBySymbol(reservoirByName, names.find(r->getName()), servicePoint);
+            }
+            break;
+        }
+        case GraphEdit::ADD_PIPE: {
+            Pipe *pipe = edit.pipe;
+            uint64_t key = FlatHashMap<Pipe *>::key(pipe->getOrig()->getSymbol(), pipe->getDest()->getSymbol());
+            if (edit.replaced != nullptr)
+                pipeByEnds.insert(key, edit.replaced);
+            else
+                pipeByEnds.erase(key);
+            swapAndPop(pipeSet, pipePosition, pipe);
+            pipe->getDest()->removeIncomingPipe(pipe);
+            pipe->getOrig()->removeOutgoingPipe(pipe);
+            if (edit.freshIndex) {
+                nextPipeIndex--;
+                pipePosition.pop_back();
+            } else {
+                freePipeIndexes.push_back(pipe->getIndex());
+            }
+            delete pipe;
+            break;
+        }
+        case GraphEdit::REMOVE_PIPE: {
+            Pipe *pipe = edit.pipe;
+            uint64_t key = FlatHashMap<Pipe *>::key(pipe->getOrig()->getSymbol(), pipe->getDest()->getSymbol());
+            if (pipeByEnds.find(key) == nullptr)
+                pipeByEnds.insert(key, pipe);
+            restoreToSlot(pipeSet, pipePosition, pipe, edit.slot);
+            pipe->getDest()->restoreIncomingPipe(pipe, edit.incomingSlot);
+            pipe->getOrig()->restoreOutgoingPipe(pipe, edit.adjSlot);
+            break;
+        }
+        case GraphEdit::SET_CAPACITY:
+            edit.pipe->setCapacity(edit.capacity);
+            break;
+        case GraphEdit::SET_SERVICE_POINT_OPERATIONAL:
+            edit.servicePoint->setOperational(edit.operational);
+            break;
+        case GraphEdit::SET_PIPE_OPERATIONAL:
+            edit.pipe->setOperational(edit.operational);
+            break;
+    }
+}
+
+/**
+ * @brief Frees what a committed change left behind: a removed ServicePoint or Pipe and its index
+ * @param edit
+ */
+void Graph::release(const GraphEdit &edit) {
+    if (edit.kind == GraphEdit::REMOVE_SERVICE_POINT) {
+        freeServicePointIndexes.push_back(edit.servicePoint->getIndex());
+        delete edit.servicePoint;
+    } else if (edit.kind == GraphEdit::REMOVE_PIPE) {
+        freePipeIndexes.push_back(edit.pipe->getIndex());
+        delete edit.pipe;
+    }
 }
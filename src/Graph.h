@@ -2,8 +2,9 @@
 #define PROJECT1_GRAPH_H
 
 #include <vector>
-#include <unordered_map>
 #include <limits>
+#include "FlatHashMap.h"
+#include "SymbolTable.h"
 #include "ServicePoint.h"
 #include "Pipe.h"
 #include "Reservoir.h"
@@ -13,24 +14,36 @@
 #define INF std::numeric_limits<int>::max()
 
 /**
- * @brief Graph Class definition
+ * @brief Undo record of one change made to a Graph inside a transaction
  */
-class Graph {
-
-    struct PipeHash {
-        std::size_t operator()(const std::pair<std::string, std::string>& p) const {
-            std::size_t spAHash = std::hash<std::string>{}(p.first);
-            std::size_t spBHash = std::hash<std::string>{}(p.second);
-            return spAHash ^ (spBHash << 1);
-        }
+struct GraphEdit {
+    enum Kind {
+        ADD_SERVICE_POINT,
+        REMOVE_SERVICE_POINT,
+        ADD_PIPE,
+        REMOVE_PIPE,
+        SET_CAPACITY,
+        SET_SERVICE_POINT_OPERATIONAL,
+        SET_PIPE_OPERATIONAL
     };
 
-    struct PipeEqual {
-        bool operator()(const std::pair<std::string, std::string>& lhs, const std::pair<std::string, std::string>& rhs) const {
-            return lhs.first == rhs.first && lhs.second == rhs.second;
-        }
-    };
+    Kind kind;
+    ServicePoint *servicePoint = nullptr; // ServicePoint changed, nullptr for a Pipe
+    Pipe *pipe = nullptr; // Pipe changed, a single direction, nullptr for a ServicePoint
+    Pipe *replaced = nullptr; // ADD_PIPE: Pipe with the same ends that the lookup by ends gave before
+    int slot = -1; // REMOVE: position in servicePointSet or pipeSet
+    int groupSlot = -1; // REMOVE_SERVICE_POINT: position in reservoirSet or citySet
+    int adjSlot = -1; // REMOVE_PIPE: position in the outgoing Pipes of the origin
+    int incomingSlot = -1; // REMOVE_PIPE: position in the incoming Pipes of the destination
+    bool freshIndex = false; // ADD: the index was new rather than reused
+    double capacity = 0; // SET_CAPACITY: capacity before
+    bool operational = true; // SET_OPERATIONAL: state before
+};
 
+/**
+ * @brief Graph Class definition
+ */
+class Graph {
 public:
     ~Graph();
 
@@ -41,30 +54,80 @@ public:
     void addServicePoint(ServicePoint *servicePoint);
     void removeServicePoint(ServicePoint *servicePoint);
 
-    void addPipe(std::string spA, std::string spB, int capacity);
-    void addBidirectionalPipe(std::string spA, std::string spB, int capacity);
+    void addPipe(const std::string &spA, const std::string &spB, int capacity);
+    void addPipe(uint32_t spA, uint32_t spB, int capacity);
+    void addBidirectionalPipe(const std::string &spA, const std::string &spB, int capacity);
+    void addBidirectionalPipe(uint32_t spA, uint32_t spB, int capacity);
     void removeAssociatedPipes(ServicePoint * servicePoint);
     void removePipe(Pipe * pipe);
+    void setPipeCapacity(Pipe * pipe, int capacity);
+    void setOperational(ServicePoint * servicePoint, bool operational);
+    void setOperational(Pipe * pipe, bool operational);
+    void reserveServicePoints(std::size_t additional);
+    void reservePipes(std::size_t additional);
+
+    Span<ServicePoint *> getServicePointSet() const;
+    Span<ServicePoint *> getReservoirSet() const;
+    Span<ServicePoint *> getCitiesSet() const;
+    Span<Pipe *> getPipeSet() const;
+    std::vector<ServicePoint *> getCitiesByCode() const;
+    static bool codeLess(const std::string &a, const std::string &b);
+    int getServicePointIndexBound() const;
+    int getPipeIndexBound() const;
+    unsigned long getVersion() const;
+    ServicePoint * getServicePoint(int index) const;
+    Pipe * getPipe(int index) const;
 
-    std::vector<ServicePoint *> getServicePointSet() const;
-    std::vector<ServicePoint *> getReservoirSet() const;
-    std::vector<ServicePoint *> getCitiesSet() const;
-    std::vector<Pipe *> getPipeSet() const;
+    uint32_t getSymbol(std::string_view code) const;
+    ServicePoint * getServicePointBySymbol(uint32_t symbol) const;
+    Pipe * getPipeBySymbols(uint32_t orig, uint32_t dest) const;
 
-    Pipe * getPipeByEnds(std::string orig, std::string dest);
-    ServicePoint * getCityByName(const std::string & name);
-    ServicePoint * getReservoirByName(const std::string & name);
-    ServicePoint * findServicePoint(const std::string &code) ;
+    Pipe * getPipeByEnds(const std::string &orig, const std::string &dest) const;
+    ServicePoint * getCityByName(const std::string & name) const;
+    ServicePoint * getReservoirByName(const std::string & name) const;
+    ServicePoint * findServicePoint(const std::string &code) const;
+
+    std::size_t beginTransaction();
+    void commitTransaction(std::size_t mark);
+    void rollbackTransaction(std::size_t mark);
+    bool inTransaction() const;
+    const std::vector<GraphEdit> & getJournal() const;
+
+    void addMemoryUsage(MemoryReport &report) const;
 
 protected:
+    int takeServicePointIndex();
+    int takePipeIndex();
+    ServicePoint * requireServicePoint(uint32_t symbol) const;
+    Pipe * newPipe(ServicePoint *orig, ServicePoint *dest, int capacity);
+    void detachPipe(Pipe *pipe);
+    void eraseByEnds(Pipe *pipe);
+    void record(const GraphEdit &edit);
+    void undo(const GraphEdit &edit);
+    void release(const GraphEdit &edit);
+
     std::vector<ServicePoint *> servicePointSet;
     std::vector<ServicePoint *> reservoirSet;
     std::vector<ServicePoint *> citySet;
     std::vector<Pipe *> pipeSet;
-    std::unordered_map<std::string,ServicePoint*> servicePointByCode;
-    std::unordered_map<std::string,ServicePoint*> cityByName;
-    std::unordered_map<std::string,ServicePoint*> reservoirByName;
-    std::unordered_map<std::pair<std::string,std::string>,Pipe*, PipeHash, PipeEqual> pipeByEnds;
+    SymbolTable codes; // ServicePoint codes, interned once so that lookups inside the Graph use their ids
+    SymbolTable names; // City and Reservoir names
+    std::vector<ServicePoint *> servicePointBySymbol; // indexed by code id, nullptr once removed
+    std::vector<ServicePoint *> cityByName; // indexed by name id
+    std::vector<ServicePoint *> reservoirByName; // indexed by name id
+    FlatHashMap<Pipe *> pipeByEnds; // keyed by the code ids of both ends
+    int nextServicePointIndex = 0;
+    int nextPipeIndex = 0;
+    std::vector<int> freeServicePointIndexes; // indexes of removed ServicePoints, given again before new ones
+    std::vector<int> freePipeIndexes; // indexes of removed Pipes, given again before new ones
+    std::vector<int> servicePointPosition; // position in servicePointSet of each ServicePoint index
+    std::vector<int> groupPosition; // position in reservoirSet or citySet of each ServicePoint index
+    std::vector<int> pipePosition; // position in pipeSet of each Pipe index
+    std::vector<GraphEdit> journal; // changes made since the outermost open transaction began
+    std::vector<std::size_t> transactionMarks; // journal size when each open transaction began, innermost last
+    std::vector<unsigned long> transactionVersions; // version when each open transaction began, innermost last
+    unsigned long version = 0; // changed on every change of the network structure, capacities or operational state
+    unsigned long lastVersion = 0; // highest version given, so that a version never names two networks
 };
 
 #endif //PROJECT1_GRAPH_H
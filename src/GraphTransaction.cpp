@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <stdexcept>
+#include "GraphTransaction.h"
+
+/**
+ * @brief Opens a transaction on a Graph
+ * @param g
+ */
+GraphTransaction::GraphTransaction(Graph *g) : g(g), mark(g->beginTransaction()) {}
+
+/**
+ * @brief Rolls the transaction back, unless it was committed or rolled back already
+ */
+GraphTransaction::~GraphTransaction() {
+    if (open)
+        g->rollbackTransaction(mark);
+}
+
+/**
+ * @brief Keeps the changes of the transaction, handing them to the enclosing transaction if there is one
+ * @details Throws a logic_error if the transaction is closed or an inner one is still open
+ */
+void GraphTransaction::commit() {
+    if (!open) {
+        throw std::logic_error("Transaction is already closed");
+    }
+    g->commitTransaction(mark);
+    open = false;
+}
+
+/**
+ * @brief Undoes the changes of the transaction, latest first
+ * @details Throws a logic_error if the transaction is closed or an inner one is still open.
+ * Time Complexity O(E), E = number of changes
+ */
+void GraphTransaction::rollback() {
+    if (!open) {
+        throw std::logic_error("Transaction is already closed");
+    }
+    g->rollbackTransaction(mark);
+    open = false;
+}
+
+/**
+ * @brief Checks if the transaction can still be committed or rolled back
+ * @return open
+ */
+bool GraphTransaction::isOpen() const {
+    return open;
+}
+
+/**
+ * @brief Gets the number of changes recorded by the transaction, including those of committed inner transactions
+ * @return count
+ */
+std::size_t GraphTransaction::getEditCount() const {
+    return open ? g->getJournal().size() - mark : 0;
+}
+
+/**
+ * @brief Gets the indexes of the ServicePoints added, removed or put in or out of operation by the transaction
+ * @return sorted indexes, without repeats
+ * @details Time Complexity O(E log E), E = number of changes
+ */
+std::vector<int> GraphTransaction::getTouchedServicePoints() const {
+    std::vector<int> touched;
+    if (!open)
+        return touched;
+    const std::vector<GraphEdit> &journal = g->getJournal();
+    for (std::size_t i = mark; i < journal.size(); i++) {
+        if (journal[i].servicePoint != nullptr)
+            touched.push_back(journal[i].servicePoint->getIndex());
+    }
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+    return touched;
+}
+
+/**
+ * @brief Gets the indexes of the Pipes added, removed or changed by the transaction, each direction on its own
+ * @return sorted indexes, without repeats
+ * @details Time Complexity O(E log E), E = number of changes
+ */
+std::vector<int> GraphTransaction::getTouchedPipes() const {
+    std::vector<int> touched;
+    if (!open)
+        return touched;
+    const std::vector<GraphEdit> &journal = g->getJournal();
+    for (std::size_t i = mark; i < journal.size(); i++) {
+        if (journal[i].pipe != nullptr)
+            touched.push_back(journal[i].pipe->getIndex());
+    }
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+    return touched;
+}
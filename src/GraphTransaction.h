@@ -0,0 +1,37 @@
+#ifndef PROJECT1_GRAPHTRANSACTION_H
+#define PROJECT1_GRAPHTRANSACTION_H
+
+#include <vector>
+#include "Graph.h"
+
+/**
+ * @brief Scoped what-if on a Graph: every status, capacity and topology change made through the Graph while it is
+ * open is recorded, and undone when it is rolled back or goes out of scope without a commit, also when a query throws
+ * @details Transactions nest, so several changes can be composed and undone together or one scope at a time, but they
+ * must be closed innermost first. Undoing takes time proportional to the number of changes, not to the Graph, and
+ * brings back the Graph version, so snapshots taken before the transaction stay valid. The elements touched are listed
+ * so that a solver can repair a previous flow around them instead of solving again.
+ */
+class GraphTransaction {
+public:
+    explicit GraphTransaction(Graph *g);
+    ~GraphTransaction();
+
+    GraphTransaction(const GraphTransaction &) = delete;
+    GraphTransaction & operator=(const GraphTransaction &) = delete;
+
+    void commit();
+    void rollback();
+    bool isOpen() const;
+
+    std::size_t getEditCount() const;
+    std::vector<int> getTouchedServicePoints() const;
+    std::vector<int> getTouchedPipes() const;
+
+private:
+    Graph *g;
+    std::size_t mark; // journal size when the transaction began
+    bool open = true;
+};
+
+#endif //PROJECT1_GRAPHTRANSACTION_H
@@ -1,93 +1,192 @@
 #include <algorithm>
 #include <stdexcept>
 #include "Management.h"
+#include "ThreadPool.h"
+#include "GraphTransaction.h"
+#include "ResultStore.h"
+#include "TraceRecorder.h"
+
+/**
+ * @brief Orders Pipes by the codes of their origin, then of their destination
+ * @param a
+ * @param b
+ * @return true if a comes before b
+ */
+static bool pipeLess(Pipe *a, Pipe *b) {
+    if (a->getOrig() != b->getOrig())
+        return Graph::codeLess(a->getOrig()->getCode(), b->getOrig()->getCode());
+    return Graph::codeLess(a->getDest()->getCode(), b->getDest()->getCode());
+}
 
 /**
  * @brief Management Constructor
  * @param graph graph to be managed
  */
-Management::Management(Graph *graph) {
+Management::Management(Graph *graph): residual(graph), state(residual), baseline(residual) {
     this->g=graph;
 }
 
+/**
+ * @brief Sets the max flow algorithm used by every query. Changing it drops the baseline max flow, which is solved again
+ * with the new algorithm
+ * @param algorithm
+ */
+void Management::setAlgorithm(FlowAlgorithm algorithm) {
+    if (algorithm != this->algorithm)
+        maxFlowCity.clear();
+    this->algorithm = algorithm;
+}
+
+/**
+ * @brief Sets if failure analyses repair the cached baseline flow instead of solving from scratch
+ * @param incremental
+ */
+void Management::setIncremental(bool incremental) {
+    this->incremental = incremental;
+}
+
+/**
+ * @brief Checks if failure analyses repair the cached baseline flow instead of solving from scratch
+ * @return incremental
+ */
+bool Management::isIncremental() const {
+    return incremental;
+}
+
+/**
+ * @brief Gets the max flow algorithm used by every query
+ * @return algorithm
+ */
+FlowAlgorithm Management::getAlgorithm() const {
+    return algorithm;
+}
+
+/**
+ * @brief Gets the residual graph snapshot of the Graph, rebuilding it if the Graph changed since it was built. A
+ * rebuild also drops the baseline max flow, which belongs to the old network
+ * @return snapshot
+ * @details Time Complexity O(1), O(S+P) when rebuilt, S = number of ServicePoints, P = number of Pipes
+ */
+const ResidualGraph & Management::getResidualGraph() {
+    if (residual.getVersion() != g->getVersion()) {
+        SOLVER_PHASE(state, SolverPhase::SETUP);
+        residual.build(g);
+        maxFlowCity.clear();
+    }
+    return residual;
+}
+
+/**
+ * @brief Computes the max flow from s to t with the selected algorithm
+ * @param state - FlowState of the solve, grown to fit the Graph
+ * @param r - snapshot of the Graph
+ * @param s - source ServicePoint
+ * @param t - target ServicePoint
+ * @param reset - start from a null flow, otherwise keep augmenting the current (valid) flow
+ * @details Time Complexity O(S*P²) with EdmondsKarp, O(S²*P) with Dinic and O(S³) with push-relabel, S = number of ServicePoints, P = number of Pipes
+ */
+void Management::maxFlow(FlowState &state, const ResidualGraph &r, int s, int t, bool reset) {
+    {
+        SOLVER_PHASE(state, SolverPhase::SETUP);
+        state.resize(r);
+    }
+    SOLVER_PHASE(state, SolverPhase::SOLVE);
+    switch (algorithm) {
+        case FlowAlgorithm::DINIC:
+            dinic(state, r, s, t, reset);
+            break;
+        case FlowAlgorithm::PUSH_RELABEL:
+            pushRelabel(state, r, s, t, reset);
+            break;
+        default:
+            edmondsKarp(state, r, s, t, reset);
+    }
+}
+
+/**
+ * @brief Gets the residual capacity of an arc
+ * @param state - FlowState of the solve
+ * @param r - snapshot of the Graph
+ * @param a - arc
+ * @return residual capacity, 0 if its Pipe or the ServicePoint it enters failed
+ * @details Time Complexity O(1)
+ */
+double Management::getResidual(const FlowState &state, const ResidualGraph &r, int a) {
+    const ResidualArc &arc = r.getArc(a);
+    if (state.isPipeFailed(arc.pipe) || state.isServicePointFailed(arc.head))
+        return 0;
+    return arc.forward ? r.getCapacity(arc.pipe) - state.getFlow(arc.pipe) : state.getFlow(arc.pipe);
+}
+
 /**
  * @brief Checks if the Service Point is not visited and there is residual capacity, then marks as visited, sets path, and enqueue it
+ * @param state - FlowState of the solve
  * @param q - queue of ServicePoints
- * @param e - Pipe
+ * @param a - arc entering w
  * @param w - ServicePoint
  * @param residual
  * @details Time Complexity O(1)
  */
-void Management::testAndVisit(std::queue<ServicePoint*> &q, Pipe*e, ServicePoint *w, double residual) {
-    if(!w->isVisited() && residual>0 && w->isOperational() && e->isOperational()){
-        w->setVisited(true);
-        w->setPath(e);
-        q.push(w);
+void Management::testAndVisit(FlowState &state, std::vector<int> &q, int a, int w, double residual) {
+    if(!state.isVisited(w) && residual>0){
+        state.setVisited(w);
+        state.setPath(w, a);
+        q.push_back(w);
     }
 }
 
 /**
  * @brief Finds an augmenting path using Breadth-First Search
+ * @param state - FlowState of the solve
+ * @param r - snapshot of the Graph
  * @param s - source ServicePoint
  * @param t - target ServicePoint
  * @return True if path is found
- * @details Time Complexity O(S+P) and O(P*log(P)) if balanced, S = number of ServicePoints, P = number of Pipes
+ * @details Time Complexity O(S+P), S = number of ServicePoints, P = number of Pipes
  */
-bool Management::findAugmentingPath( ServicePoint *s, ServicePoint *t) {
+bool Management::findAugmentingPath(FlowState &state, const ResidualGraph &r, int s, int t) {
     // Mark all vertices as not visited
-    for(ServicePoint*v:g->getServicePointSet()){
-        v->setVisited(false);
-    }
+    state.clearVisited();
+    SOLVER_COUNT(state, searches, 1);
 
     // Mark the source ServicePoint as visited and enqueue it
-    s->setVisited(true);
-    std::queue<ServicePoint*> q;
-    q.push(s);
+    state.setVisited(s);
+    std::vector<int> &q = state.getQueue();
+    q.push_back(s);
 
-    // BFS to find an augmenting path
-    while(!q.empty() && !t->isVisited()){
-        auto v=q.front();
-        q.pop();
-        if(!v->isOperational())
+    // BFS to find an augmenting path, through the outgoing Pipes and then the incoming ones
+    for(size_t head=0; head<q.size() && !state.isVisited(t); head++){
+        int v=q[head];
+        if(state.isServicePointFailed(v))
             continue;
-      
-        std::vector<Pipe*> pipes = v->getAdj();
-        std::vector<Pipe*> inpipes = v->getIncoming();
 
-        // Process outgoing Pipes
-        for (Pipe *e: pipes) {
-            testAndVisit(q, e, e->getDest(), e->getCapacity() - e->getFlow());
-        }
-        // Process incoming Pipes
-        for (Pipe *e: inpipes) {
-            testAndVisit(q, e, e->getOrig(), e->getFlow());
+        SOLVER_COUNT(state, arcsScanned, r.getArcEnd(v) - r.getArcBegin(v));
+        for (int a = r.getArcBegin(v); a < r.getArcEnd(v); a++) {
+            testAndVisit(state, q, a, r.getArc(a).head, getResidual(state, r, a));
         }
     }
     // Return true if a path to the target is found, false otherwise
-    return t->isVisited();
+    return state.isVisited(t);
 }
 
 /**
  * @brief Find the minimum residual capacity along the augmenting path
+ * @param state - FlowState of the solve
+ * @param r - snapshot of the Graph
  * @param s - source ServicePoint
  * @param t - target ServicePoint
  * @return f
  * @details Time Complexity O(P) P = number of Pipes between s and t
  */
-double Management::findMinResidualAlongPath(ServicePoint *s, ServicePoint *t) {
+double Management::findMinResidualAlongPath(FlowState &state, const ResidualGraph &r, int s, int t) {
     double f = INF;
     // Traverse the augmenting path to find the minimum residual capacity
-    ServicePoint *v=t;
+    int v=t;
     while(v!=s){
-        auto e=v->getPath();
-        if(e->getDest()==v){
-            f=std::min(f,e->getCapacity()-e->getFlow());
-            v=e->getOrig();
-        }
-        else{
-            f=std::min(f,e->getFlow());
-            v=e->getDest();
-        }
+        int a=state.getPath(v);
+        const ResidualArc &arc = r.getArc(a);
+        f=std::min(f, arc.forward ? r.getCapacity(arc.pipe)-state.getFlow(arc.pipe) : state.getFlow(arc.pipe));
+        v=r.getTail(a);
     }
     // Return the minimum residual capacity
     return f;
@@ -95,93 +194,809 @@ double Management::findMinResidualAlongPath(ServicePoint *s, ServicePoint *t) {
 
 /**
  * @brief Augments the flow along the augmenting path with the given flow value
+ * @param state - FlowState of the solve
+ * @param r - snapshot of the Graph
  * @param s - source ServicePoint
  * @param t - target ServicePoint
  * @param f - flow value
  * @details Time Complexity O(P) P = number of Pipes between s and t
  */
-void Management::augmentFlowAlongPath(ServicePoint *s, ServicePoint *t, double f) {
-    ServicePoint *v=t;
+void Management::augmentFlowAlongPath(FlowState &state, const ResidualGraph &r, int s, int t, double f) {
+    state.countAugmentation();
+    int v=t;
     while(v!=s){
-        auto e=v->getPath();
-        double flow=e->getFlow();
-        if(e->getDest()==v){
-            e->setFlow(flow+f);
-            v=e->getOrig();
-        }
-        else{
-            e->setFlow(flow-f);
-            v=e->getDest();
-        }
+        int a=state.getPath(v);
+        const ResidualArc &arc = r.getArc(a);
+        double flow=state.getFlow(arc.pipe);
+        state.setFlow(arc.pipe, arc.forward ? flow+f : flow-f);
+        v=r.getTail(a);
     }
 }
 
 /**
  * @brief Performs the EdmondsKarp
+ * @param state - FlowState of the solve
+ * @param r - snapshot of the Graph
  * @param s - source ServicePoint
  * @param t - target ServicePoint
+ * @param reset - start from a null flow, otherwise keep augmenting the current (valid) flow
  * @details Time Complexity O(S*P²), S = number of ServicePoints, P = number of Pipes
  */
-void Management::edmondsKarp( ServicePoint* s, ServicePoint* t) {
+void Management::edmondsKarp(FlowState &state, const ResidualGraph &r, int s, int t, bool reset) {
+    TRACE_SCOPE("solver", "edmondsKarp");
 
     // Validate source and target vertices
-    if(s==nullptr || t== nullptr || s==t){
+    if(s<0 || t<0 || s==t){
         throw std::logic_error("Invalid source and/or target ServicePoint");
     }
 
     // Initialize flow on all Pipes to 0
-    for(ServicePoint* v:g->getServicePointSet()){
-        v->setPath(nullptr);
-        for(Pipe* e : v->getAdj()){
-            e->setFlow(0);
-        }
+    if (reset) {
+        state.reset();
     }
 
     // While there is an augmenting path, augment the flow along the path
-    while(findAugmentingPath(s,t)){
-        double f = findMinResidualAlongPath(s,t);
-        augmentFlowAlongPath(s,t,f);
+    while(findAugmentingPath(state,r,s,t)){
+        double f = findMinResidualAlongPath(state,r,s,t);
+        augmentFlowAlongPath(state,r,s,t,f);
     }
 }
 
 /**
- * @brief Gets the max flow overall.
- * @return flowPerCity
- * @details Time Complexity O(S*P²), S = number of ServicePoints, P = number of Pipes
+ * @brief Builds the level graph of the residual network using Breadth-First Search
+ * @param state - FlowState of the solve
+ * @param r - snapshot of the Graph
+ * @param s - source ServicePoint
+ * @param t - target ServicePoint
+ * @return True if t is reachable from s
+ * @details Time Complexity O(S+P), S = number of ServicePoints, P = number of Pipes
  */
-std::unordered_map<std::string,int> Management::getMaxFlow() {
-    Reservoir *superSource = new Reservoir("supersource", "x","0", "SRC", INF);
-    g->addReservoir(superSource);
-    for(ServicePoint* v:g->getReservoirSet()){
-        if (v->getCode() != "SRC") {
-            g->addPipe("SRC", v->getCode(), ((Reservoir*)v)->getMaxDelivery());
+bool Management::buildLevelGraph(FlowState &state, const ResidualGraph &r, int s, int t) {
+    // Reset levels and current arcs
+    state.clearLevels();
+    SOLVER_COUNT(state, searches, 1);
+
+    state.setLevel(s, 0);
+    std::vector<int> &q = state.getQueue();
+    q.push_back(s);
+
+    // BFS over the residual arcs, no need to go further than t
+    for(size_t head=0; head<q.size(); head++){
+        int v=q[head];
+        if(state.isServicePointFailed(v) || (state.getLevel(t) != -1 && state.getLevel(v) >= state.getLevel(t)))
+            continue;
+
+        SOLVER_COUNT(state, arcsScanned, r.getArcEnd(v) - r.getArcBegin(v));
+        for (int a = r.getArcBegin(v); a < r.getArcEnd(v); a++) {
+            int w = r.getArc(a).head;
+            if (getResidual(state, r, a) > 0 && state.getLevel(w) == -1) {
+                state.setLevel(w, state.getLevel(v) + 1);
+                q.push_back(w);
+            }
+        }
+    }
+    return state.getLevel(t) != -1;
+}
+
+/**
+ * @brief Checks if an arc leaving v is in the level graph
+ * @param state - FlowState of the solve
+ * @param r - snapshot of the Graph
+ * @param v - ServicePoint the arc leaves
+ * @param a - arc
+ * @return True if the arc has residual capacity and goes one level deeper
+ * @details Time Complexity O(1)
+ */
+bool Management::isLevelArc(const FlowState &state, const ResidualGraph &r, int v, int a) {
+    return getResidual(state, r, a) > 0 && state.getLevel(r.getArc(a).head) == state.getLevel(v) + 1;
+}
+
+/**
+ * @brief Saturates the level graph with a blocking flow, advancing and retreating from s with the current arc of each ServicePoint
+ * @param state - FlowState of the solve
+ * @param r - snapshot of the Graph
+ * @param s - source ServicePoint
+ * @param t - target ServicePoint
+ * @details Time Complexity O(S*P), S = number of ServicePoints, P = number of Pipes
+ */
+void Management::sendBlockingFlow(FlowState &state, const ResidualGraph &r, int s, int t) {
+    int v = s;
+    while (true) {
+        // Reached t, augment along the path and start again from s
+        if (v == t) {
+            double f = findMinResidualAlongPath(state, r, s, t);
+            augmentFlowAlongPath(state, r, s, t, f);
+            v = s;
+            continue;
+        }
+
+        // Advance through the current arc, skipping the ones that are no longer usable
+        int a = r.getArcBegin(v) + state.getCurrentArc(v);
+        SOLVER_COUNT(state, arcsScanned, a < r.getArcEnd(v) ? 1 : 0);
+        while (a < r.getArcEnd(v) && !isLevelArc(state, r, v, a)) {
+            a++;
+            SOLVER_COUNT(state, arcsScanned, a < r.getArcEnd(v) ? 1 : 0);
+        }
+        state.setCurrentArc(v, a - r.getArcBegin(v));
+        if (a < r.getArcEnd(v)) {
+            v = r.getArc(a).head;
+            state.setPath(v, a);
+            continue;
+        }
+
+        // Dead end, remove v from the level graph and retreat
+        if (v == s)
+            break;
+        state.setLevel(v, -1);
+        v = r.getTail(state.getPath(v));
+        state.setCurrentArc(v, state.getCurrentArc(v) + 1);
+    }
+}
+
+/**
+ * @brief Performs the Dinic max flow algorithm
+ * @param state - FlowState of the solve
+ * @param r - snapshot of the Graph
+ * @param s - source ServicePoint
+ * @param t - target ServicePoint
+ * @param reset - start from a null flow, otherwise keep augmenting the current (valid) flow
+ * @details Time Complexity O(S²*P), S = number of ServicePoints, P = number of Pipes
+ */
+void Management::dinic(FlowState &state, const ResidualGraph &r, int s, int t, bool reset) {
+    TRACE_SCOPE("solver", "dinic");
+
+    // Validate source and target vertices
+    if(s<0 || t<0 || s==t){
+        throw std::logic_error("Invalid source and/or target ServicePoint");
+    }
+
+    // Initialize flow on all Pipes to 0
+    if (reset) {
+        state.reset();
+    }
+
+    // While t is reachable in the residual network, saturate the level graph
+    while(buildLevelGraph(state,r,s,t)){
+        sendBlockingFlow(state,r,s,t);
+    }
+}
+
+/**
+ * @brief Sets every height to the exact residual distance to t, or to s plus the number of ServicePoints for those that can no longer reach t
+ * @param state - FlowState of the solve
+ * @param r - snapshot of the Graph
+ * @param s - source ServicePoint
+ * @param t - target ServicePoint
+ * @param heightCount - number of ServicePoints with each height, rebuilt
+ * @details Time Complexity O(S+P), S = number of ServicePoints, P = number of Pipes
+ */
+void Management::globalRelabel(FlowState &state, const ResidualGraph &r, int s, int t, std::vector<int> &heightCount) {
+    const std::vector<int> &nodes = r.getServicePoints();
+    int n = (int) nodes.size();
+    for (int v : nodes) {
+        state.setHeight(v, 2 * n);
+        state.setCurrentArc(v, 0);
+    }
+    state.setHeight(t, 0);
+    state.setHeight(s, n);
+
+    // Reverse BFS from t and then from s, a ServicePoint u gets labeled through v if the residual arc u->v exists
+    SOLVER_COUNT(state, searches, 1);
+    for (int root : {t, s}) {
+        std::vector<int> &q = state.getQueue();
+        q.push_back(root);
+        for (size_t head = 0; head < q.size(); head++) {
+            int v = q[head];
+            SOLVER_COUNT(state, arcsScanned, r.getArcEnd(v) - r.getArcBegin(v));
+            for (int a = r.getArcBegin(v); a < r.getArcEnd(v); a++) {
+                const ResidualArc &arc = r.getArc(a);
+                int u = arc.head;
+                if (state.getHeight(u) == 2 * n && getResidual(state, r, arc.reverse) > 0) {
+                    state.setHeight(u, state.getHeight(v) + 1);
+                    q.push_back(u);
+                }
+            }
+        }
+    }
+
+    std::fill(heightCount.begin(), heightCount.end(), 0);
+    for (int v : nodes) {
+        heightCount[state.getHeight(v)]++;
+    }
+}
+
+/**
+ * @brief Lifts v just above its lowest residual neighbour. If its old height becomes empty (gap), every ServicePoint
+ * above the gap is cut off from t and is lifted above the source
+ * @param state - FlowState of the solve
+ * @param r - snapshot of the Graph
+ * @param v - ServicePoint to relabel
+ * @param heightCount - number of ServicePoints with each height
+ * @details Time Complexity O(P) and O(S+P) when there is a gap, S = number of ServicePoints, P = number of Pipes
+ */
+void Management::relabel(FlowState &state, const ResidualGraph &r, int v, std::vector<int> &heightCount) {
+    const std::vector<int> &nodes = r.getServicePoints();
+    int n = (int) nodes.size();
+    int oldHeight = state.getHeight(v);
+    int newHeight = 2 * n;
+    SOLVER_COUNT(state, relabels, 1);
+    SOLVER_COUNT(state, arcsScanned, r.getArcEnd(v) - r.getArcBegin(v));
+    for (int a = r.getArcBegin(v); a < r.getArcEnd(v); a++) {
+        if (getResidual(state, r, a) > 0) {
+            newHeight = std::min(newHeight, state.getHeight(r.getArc(a).head) + 1);
         }
     }
-    City *superSink = new City("supersink","01","SINK",INF,INF);
-    g->addCity(superSink);
-    for(ServicePoint* v:g->getCitiesSet()){
-        if (v->getCode() != "SINK") {
-            g->addPipe(v->getCode(), "SINK", ((City*)v)->getDemand());
+    heightCount[oldHeight]--;
+    state.setHeight(v, newHeight);
+    heightCount[newHeight]++;
+    state.setCurrentArc(v, 0);
+
+    // Gap heuristic
+    if (heightCount[oldHeight] == 0 && oldHeight < n) {
+        for (int u : nodes) {
+            if (state.getHeight(u) > oldHeight && state.getHeight(u) < n) {
+                heightCount[state.getHeight(u)]--;
+                state.setHeight(u, n + 1);
+                heightCount[n + 1]++;
+                state.setCurrentArc(u, 0);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Pushes the excess of v through its admissible arcs, relabeling it when it has none left
+ * @param state - FlowState of the solve
+ * @param r - snapshot of the Graph
+ * @param v - active ServicePoint
+ * @param s - source ServicePoint
+ * @param t - target ServicePoint
+ * @param active - FIFO queue of ServicePoints with excess
+ * @param heightCount - number of ServicePoints with each height
+ * @return number of relabels done
+ * @details Time Complexity O(S*P), S = number of ServicePoints, P = number of Pipes
+ */
+int Management::discharge(FlowState &state, const ResidualGraph &r, int v, int s, int t, std::queue<int> &active, std::vector<int> &heightCount) {
+    int relabels = 0;
+    int maxHeight = 2 * (int) r.getServicePoints().size();
+    while (state.getExcess(v) > 0 && state.getHeight(v) < maxHeight) {
+        int a = r.getArcBegin(v) + state.getCurrentArc(v);
+        if (a == r.getArcEnd(v)) {
+            relabel(state, r, v, heightCount);
+            relabels++;
+            continue;
         }
+
+        const ResidualArc &arc = r.getArc(a);
+        int w = arc.head;
+        double residual = getResidual(state, r, a);
+        SOLVER_COUNT(state, arcsScanned, 1);
+        if (residual > 0 && state.getHeight(v) == state.getHeight(w) + 1) {
+            double f = std::min(state.getExcess(v), residual);
+            state.countAugmentation();
+            state.setFlow(arc.pipe, arc.forward ? state.getFlow(arc.pipe) + f : state.getFlow(arc.pipe) - f);
+            state.setExcess(v, state.getExcess(v) - f);
+            if (state.getExcess(w) == 0 && w != s && w != t)
+                active.push(w);
+            state.setExcess(w, state.getExcess(w) + f);
+        } else {
+            state.setCurrentArc(v, state.getCurrentArc(v) + 1);
+        }
+    }
+    return relabels;
+}
+
+/**
+ * @brief Performs the FIFO push-relabel max flow algorithm with global relabeling and the gap heuristic
+ * @param state - FlowState of the solve
+ * @param r - snapshot of the Graph
+ * @param s - source ServicePoint
+ * @param t - target ServicePoint
+ * @param reset - start from a null flow, otherwise keep augmenting the current (valid) flow
+ * @details Time Complexity O(S³), S = number of ServicePoints
+ */
+void Management::pushRelabel(FlowState &state, const ResidualGraph &r, int s, int t, bool reset) {
+    TRACE_SCOPE("solver", "pushRelabel");
+
+    // Validate source and target vertices
+    if(s<0 || t<0 || s==t){
+        throw std::logic_error("Invalid source and/or target ServicePoint");
+    }
+
+    // Initialize excess on all ServicePoints and flow on all Pipes to 0
+    if (reset) {
+        state.reset();
+    }
+    for(int v : r.getServicePoints()){
+        state.setPath(v, -1);
+        state.setExcess(v, 0);
+    }
+    int n = (int) r.getServicePoints().size();
+    std::vector<int> heightCount(2 * n + 1, 0);
+    globalRelabel(state, r, s, t, heightCount);
+
+    // Saturate every Pipe leaving the source
+    std::queue<int> active;
+    for (int a = r.getArcBegin(s); a < r.getArcEnd(s); a++) {
+        const ResidualArc &arc = r.getArc(a);
+        double residual = getResidual(state, r, a);
+        if (!arc.forward || residual <= 0)
+            continue;
+        state.setFlow(arc.pipe, state.getFlow(arc.pipe) + residual);
+        if (state.getExcess(arc.head) == 0 && arc.head != t)
+            active.push(arc.head);
+        state.setExcess(arc.head, state.getExcess(arc.head) + residual);
     }
 
-    edmondsKarp(superSource,superSink);
+    // Discharge active ServicePoints in FIFO order, recomputing exact heights every n relabels
+    int relabels = 0;
+    while (!active.empty()) {
+        int v = active.front();
+        active.pop();
+        relabels += discharge(state, r, v, s, t, active, heightCount);
+        if (relabels >= n) {
+            globalRelabel(state, r, s, t, heightCount);
+            relabels = 0;
+        }
+    }
+}
 
+/**
+ * @brief Gets the flow reaching each City in a FlowState
+ * @param state - FlowState of the solve
+ * @return flowPerCity
+ * @details Time Complexity O(P), P = number of Pipes
+ */
+std::unordered_map<std::string,int> Management::getFlowPerCity(const FlowState &state) {
+    TRACE_SCOPE("format", "getFlowPerCity");
     std::unordered_map<std::string,int> flowPerCity;
-    g->removeServicePoint(superSource);
-    g->removeServicePoint(superSink);
     for(ServicePoint* v: g->getCitiesSet()){
-        double maxflow=0;
-        for(Pipe* e: v->getIncoming()){
-            maxflow+=e->getFlow();
-        }
-        flowPerCity.insert(std::make_pair(v->getCode(),maxflow));
+        flowPerCity.insert(std::make_pair(v->getCode(),getCityFlow(state,v)));
+    }
+    return flowPerCity;
+}
+
+/**
+ * @brief Gets the flow reaching a City in a FlowState
+ * @param state - FlowState of the solve
+ * @param city
+ * @return flow
+ * @details Time Complexity O(P), P = number of incoming Pipes
+ */
+int Management::getCityFlow(const FlowState &state, ServicePoint *city) {
+    double maxflow=0;
+    for(Pipe* e: city->getIncoming()){
+        maxflow+=state.getFlow(e);
+    }
+    return maxflow;
+}
+
+/**
+ * @brief Gets the max flow overall, spread over the Cities with spreadOverCities. It is kept as the baseline of the
+ * failure analyses, and answered from it while the Graph stays the same, in which case its flow is only restored in
+ * the FlowState if a metric asks for it
+ * @return flowPerCity
+ * @details Time Complexity O(1) if the baseline is kept, O(S*P²) otherwise, S = number of ServicePoints,
+ * P = number of Pipes
+ */
+std::unordered_map<std::string,int> Management::getMaxFlow() {
+    const ResidualGraph &r = getResidualGraph();
+    if (!maxFlowCity.empty()) {
+        deferred = true;
+        deferredServicePoint = nullptr;
+        deferredPipe = nullptr;
+        deferredVersion = g->getVersion();
+        return maxFlowCity;
     }
-    if(maxFlowCity.empty())
-        maxFlowCity = flowPerCity;
+    deferred = false;
+    maxFlow(state,r,r.getSuperSource(),r.getSuperSink());
+    spreadOverCities(state, r);
+
+    SOLVER_PHASE(state, SolverPhase::TEARDOWN);
+    maxFlowCity = getFlowPerCity(state);
+    baseline = state;
+    return maxFlowCity;
+}
+
+/**
+ * @brief Computes the baseline max flow of the failure analyses, if it is missing or the Graph changed since
+ * @details Time Complexity O(1), O(S*P²) when computed, S = number of ServicePoints, P = number of Pipes
+ */
+void Management::ensureBaseline() {
+    getResidualGraph();
+    if (maxFlowCity.empty())
+        getMaxFlow();
+}
+
+/**
+ * @brief Gets the max flow after a failure, leaving the Graph untouched. Recent failures are answered from the
+ * ScenarioCache while the Graph stays the same, in which case the flow of the query is only solved in the FlowState
+ * if a metric asks for it
+ * @param failedServicePoint ServicePoint that fails or nullptr
+ * @param failedPipe Pipe that fails (with its reverse) or nullptr
+ * @return flowPerCity
+ * @details Time Complexity O(C) if cached, C = number of Cities, otherwise O(F*(S+P)) in incremental mode,
+ * F = flow lost by the failure, and O(S*P²) otherwise, S = number of ServicePoints, P = number of Pipes
+ */
+std::unordered_map<std::string,int> Management::getMaxFlowAfterFailure(ServicePoint *failedServicePoint, Pipe *failedPipe) {
+    const ResidualGraph &r = getResidualGraph();
+    ScenarioCache::Scenario scenario = getScenario(failedServicePoint, failedPipe);
+    if (const ScenarioCache::FlowPerCity *cached = scenarios.find(g->getVersion(), scenario)) {
+        deferred = true;
+        deferredServicePoint = failedServicePoint;
+        deferredPipe = failedPipe;
+        deferredVersion = g->getVersion();
+        return *cached;
+    }
+    deferred = false;
+    solveFailure(state, r, failedServicePoint, failedPipe);
+    SOLVER_PHASE(state, SolverPhase::TEARDOWN);
+    std::unordered_map<std::string,int> flowPerCity = getFlowPerCity(state);
+    scenarios.insert(g->getVersion(), scenario, flowPerCity);
     return flowPerCity;
 }
 
+/**
+ * @brief Gets the canonical scenario of a failure: the failed elements, sorted and without repeats
+ * @param failedServicePoint ServicePoint that fails or nullptr
+ * @param failedPipe Pipe that fails (with its reverse) or nullptr
+ * @return scenario
+ */
+ScenarioCache::Scenario Management::getScenario(ServicePoint *failedServicePoint, Pipe *failedPipe) const {
+    ScenarioCache::Scenario scenario;
+    if (failedServicePoint != nullptr)
+        scenario.push_back(ScenarioCache::servicePointKey(failedServicePoint->getIndex()));
+    if (failedPipe != nullptr) {
+        int index = failedPipe->getIndex();
+        if (failedPipe->getReverse() != nullptr)
+            index = std::min(index, failedPipe->getReverse()->getIndex());
+        scenario.push_back(ScenarioCache::pipeKey(index));
+    }
+    std::sort(scenario.begin(), scenario.end());
+    scenario.erase(std::unique(scenario.begin(), scenario.end()), scenario.end());
+    return scenario;
+}
+
+/**
+ * @brief Solves in the FlowState the failure of the last query, if it was answered from the ScenarioCache, or
+ * restores the baseline flow if the last query was the max flow answered from it
+ * @details Time Complexity O(F*(S+P)) in incremental mode, F = flow lost by the failure, and O(S*P²) otherwise,
+ * S = number of ServicePoints, P = number of Pipes
+ */
+void Management::solveDeferred() {
+    if (!deferred)
+        return;
+    deferred = false;
+    if (deferredVersion != g->getVersion())
+        return;
+    if (deferredServicePoint == nullptr && deferredPipe == nullptr)
+        restoreBaselineFlow(state, getResidualGraph());
+    else
+        solveFailure(state, getResidualGraph(), deferredServicePoint, deferredPipe);
+}
+
+/**
+ * @brief Gets the number of augmenting paths and pushes of every query so far, including the workers of the
+ * contingency sweep
+ * @return augmentations
+ */
+unsigned long Management::getAugmentations() const {
+    return state.getAugmentations();
+}
+
+/**
+ * @brief Gets the work counters and phase times of the queries since the last reset. They stay at 0 unless the project
+ * is configured with PROJECT1_SOLVER_STATS
+ * @return stats
+ */
+const SolverStats & Management::getSolverStats() const {
+    return state.getStats();
+}
+
+/**
+ * @brief Sets the work counters and phase times back to 0, to measure the next query on its own
+ */
+void Management::resetSolverStats() {
+    state.getStats() = SolverStats();
+}
+
+/**
+ * @brief Gets the bytes held by the Graph and by the solver state of the Management, and the peak resident set size.
+ * The FlowStates of the contingency workers only live during the query, so they only show in the peak
+ * @return report
+ * @details Time Complexity O(S+P), S = number of ServicePoints, P = number of Pipes
+ */
+MemoryReport Management::getMemoryReport() const {
+    MemoryReport report;
+    g->addMemoryUsage(report);
+    report.solverScratch = residual.getMemoryUsage() + state.getMemoryUsage() + baseline.getMemoryUsage();
+    report.peakRssKb = MemoryReport::getPeakRssKb();
+    return report;
+}
+
+/**
+ * @brief Gets the cache of recent failure scenarios, to size it or read its counters
+ * @return cache
+ */
+ScenarioCache & Management::getScenarioCache() {
+    return scenarios;
+}
+
+/**
+ * @brief Spreads a max flow over the Cities in a canonical way: each City, in code order, takes as much of the max
+ * flow as it can without taking any from the Cities before it. The flow is moved around cycles through the super sink,
+ * from Cities later in the order, so the total stays the same. The flow of every City is then unique, whatever engine
+ * or starting flow found the max flow
+ * @param state - FlowState holding a max flow, with the failed elements failed
+ * @param r - snapshot of the Graph
+ * @details Time Complexity O(C*(S+P) + A*(S+P)), C = number of Cities, A = number of cycles found, S = number of
+ * ServicePoints, P = number of Pipes
+ */
+void Management::spreadOverCities(FlowState &state, const ResidualGraph &r) {
+    SOLVER_PHASE(state, SolverPhase::SOLVE);
+    TRACE_SCOPE("solver", "spreadOverCities");
+    int t = r.getSuperSink();
+    std::vector<std::pair<ServicePoint *, int>> sinks; // each City with its super sink Pipe
+    for (int a = r.getArcBegin(t); a < r.getArcEnd(t); a++) {
+        if (!r.getArc(a).forward)
+            sinks.emplace_back(g->getServicePoint(r.getArc(a).head), r.getArc(a).pipe);
+    }
+    std::sort(sinks.begin(), sinks.end(), [](const auto &a, const auto &b) {
+        return Graph::codeLess(a.first->getCode(), b.first->getCode());
+    });
+
+    // Failing the super sink Pipe of a City keeps its flow from being taken by the Cities after it
+    for (std::size_t i = 0; i + 1 < sinks.size(); i++) {
+        int city = sinks[i].first->getIndex();
+        int p = sinks[i].second;
+        state.setPipeFailed(p, true);
+        double room = r.getCapacity(p) - state.getFlow(p);
+        while (room > 0 && findAugmentingPath(state, r, t, city)) {
+            double f = std::min(room, findMinResidualAlongPath(state, r, t, city));
+            augmentFlowAlongPath(state, r, t, city, f);
+            state.setFlow(p, state.getFlow(p) + f);
+            room -= f;
+        }
+    }
+    for (const auto &sink : sinks)
+        state.setPipeFailed(sink.second, false);
+}
+
+/**
+ * @brief Takes a ServicePoint and a Pipe (with its reverse) out of operation inside a GraphTransaction, solves the
+ * network without them and rolls the transaction back, which brings back the Graph version of the snapshot
+ * @param state - FlowState of the solve
+ * @param r - snapshot of the Graph before the failure
+ * @param failedServicePoint ServicePoint that fails or nullptr
+ * @param failedPipe Pipe that fails (with its reverse) or nullptr
+ * @details Time Complexity O(F*(S+P)) in incremental mode, F = flow lost by the failure, and O(S*P²) otherwise,
+ * S = number of ServicePoints, P = number of Pipes
+ */
+void Management::solveFailure(FlowState &state, const ResidualGraph &r, ServicePoint *failedServicePoint, Pipe *failedPipe) {
+    GraphTransaction failure(g);
+    takeOutOfOperation(failedServicePoint, failedPipe);
+    solveAfterFailure(state, r, failure.getTouchedServicePoints(), failure.getTouchedPipes());
+    failure.rollback();
+}
+
+/**
+ * @brief Puts a ServicePoint and a Pipe (with its reverse) out of operation, inside the open GraphTransaction
+ * @param failedServicePoint ServicePoint or nullptr
+ * @param failedPipe Pipe or nullptr
+ */
+void Management::takeOutOfOperation(ServicePoint *failedServicePoint, Pipe *failedPipe) {
+    if (failedServicePoint != nullptr)
+        g->setOperational(failedServicePoint, false);
+    if (failedPipe != nullptr)
+        g->setOperational(failedPipe, false);
+}
+
+/**
+ * @brief Computes in a FlowState the max flow of the network without the elements a GraphTransaction took out of
+ * operation. In incremental mode the baseline flow is restored, the flow routed through those elements is cancelled
+ * and the remaining network is re-augmented from there, otherwise it is a full solve. Either way the max flow is then
+ * spread over the Cities with spreadOverCities, so both modes give each City the same flow. The elements are only
+ * failed in the FlowState, so the snapshot taken before the transaction is solved without being rebuilt
+ * @param state - FlowState of the solve
+ * @param r - snapshot of the Graph before the transaction
+ * @param failedServicePoints - indexes of the ServicePoints taken out of operation, as listed by the transaction
+ * @param failedPipes - indexes of the Pipes taken out of operation, as listed by the transaction
+ * @details Time Complexity O(F*(S+P)) in incremental mode, F = flow lost by the failure, and O(S*P²) otherwise,
+ * S = number of ServicePoints, P = number of Pipes
+ */
+void Management::solveAfterFailure(FlowState &state, const ResidualGraph &r, const std::vector<int> &failedServicePoints,
+                                   const std::vector<int> &failedPipes) {
+    TRACE_SCOPE("solver", "solveAfterFailure");
+    state.resize(r);
+    setFailed(state, failedServicePoints, failedPipes, true);
+    if (incremental && !maxFlowCity.empty()) {
+        restoreBaselineFlow(state, r);
+        repairFlow(state, r, failedServicePoints, failedPipes);
+    } else {
+        maxFlow(state, r, r.getSuperSource(), r.getSuperSink());
+    }
+    spreadOverCities(state, r);
+    setFailed(state, failedServicePoints, failedPipes, false);
+}
+
+/**
+ * @brief Fails or restores ServicePoints and Pipes in a FlowState
+ * @param state - FlowState of the solve
+ * @param failedServicePoints - indexes of the ServicePoints
+ * @param failedPipes - indexes of the Pipes
+ * @param failed
+ */
+void Management::setFailed(FlowState &state, const std::vector<int> &failedServicePoints, const std::vector<int> &failedPipes, bool failed) {
+    SOLVER_PHASE(state, failed ? SolverPhase::SETUP : SolverPhase::TEARDOWN);
+    for (int v : failedServicePoints)
+        state.setServicePointFailed(v, failed);
+    for (int p : failedPipes)
+        state.setPipeFailed(p, failed);
+}
+
+/**
+ * @brief Turns the baseline flow into a max flow of the network without the failed elements, by cancelling the flow
+ * routed through them and re-augmenting from there
+ * @param state - FlowState holding the baseline flow, with the failed elements already failed
+ * @param r - snapshot of the Graph
+ * @param failedServicePoints - indexes of the ServicePoints that failed
+ * @param failedPipes - indexes of the Pipes that failed
+ * @details Time Complexity O(F*(S+P)), F = flow lost, S = number of ServicePoints, P = number of Pipes
+ */
+void Management::repairFlow(FlowState &state, const ResidualGraph &r, const std::vector<int> &failedServicePoints,
+                            const std::vector<int> &failedPipes) {
+    SOLVER_PHASE(state, SolverPhase::SOLVE);
+    TRACE_SCOPE("solver", "repairFlow");
+    int s = r.getSuperSource();
+    int t = r.getSuperSink();
+
+    // Cancel every unit of flow that went through the failed elements
+    for (int v : failedServicePoints) {
+        for (int a = r.getArcBegin(v); a < r.getArcEnd(v); a++) {
+            if (!r.getArc(a).forward)
+                cancelFlow(state, r, r.getArc(a).pipe, s, t);
+        }
+    }
+    for (int p : failedPipes)
+        cancelFlow(state, r, p, s, t);
+
+    maxFlow(state, r, s, t, false);
+}
+
+/**
+ * @brief Puts the baseline flow back on every Pipe. The flow of the super source and super sink Pipes follows from the
+ * flow conservation on each Reservoir and City
+ * @param state - FlowState that receives the baseline flow, failed elements are kept
+ * @param r - snapshot of the Graph
+ * @details Time Complexity O(P), P = number of Pipes
+ */
+void Management::restoreBaselineFlow(FlowState &state, const ResidualGraph &r) {
+    SOLVER_PHASE(state, SolverPhase::SETUP);
+    TRACE_SCOPE("solver", "restoreBaselineFlow");
+    int s = r.getSuperSource();
+    int t = r.getSuperSink();
+    state.resize(r);
+    state.reset();
+    for (int p : r.getPipes()) {
+        int a = r.getForwardArc(p);
+        if (r.getTail(a) != s && r.getArc(a).head != t)
+            state.setFlow(p, baseline.getFlow(p));
+    }
+
+    // Flow leaving minus flow entering a ServicePoint
+    auto netOutflow = [&](int v) {
+        double f = 0;
+        for (int a = r.getArcBegin(v); a < r.getArcEnd(v); a++) {
+            const ResidualArc &arc = r.getArc(a);
+            f += arc.forward ? state.getFlow(arc.pipe) : -state.getFlow(arc.pipe);
+        }
+        return f;
+    };
+    for (int a = r.getArcBegin(s); a < r.getArcEnd(s); a++) {
+        if (r.getArc(a).forward)
+            state.setFlow(r.getArc(a).pipe, netOutflow(r.getArc(a).head));
+    }
+    for (int a = r.getArcBegin(t); a < r.getArcEnd(t); a++) {
+        if (!r.getArc(a).forward)
+            state.setFlow(r.getArc(a).pipe, -netOutflow(r.getArc(a).head));
+    }
+}
+
+/**
+ * @brief Finds a path from one ServicePoint to another using only Pipes that carry flow, with Breadth-First Search
+ * @param state - FlowState of the solve
+ * @param r - snapshot of the Graph
+ * @param from - ServicePoint where the search starts
+ * @param to - ServicePoint to reach
+ * @param stop - alternative ServicePoint to reach
+ * @param forward - follow the flow direction, otherwise go against it
+ * @param pipes - set to the Pipes of the path found, in search order
+ * @return to or stop, whichever was reached, -1 if none
+ * @details Time Complexity O(S+P), S = number of ServicePoints, P = number of Pipes
+ */
+int Management::findFlowPath(FlowState &state, const ResidualGraph &r, int from, int to, int stop, bool forward, std::vector<int> &pipes) {
+    pipes.clear();
+    if (from == to || from == stop)
+        return from;
+    state.clearVisited();
+    SOLVER_COUNT(state, searches, 1);
+
+    state.setVisited(from);
+    std::vector<int> &q = state.getQueue();
+    q.push_back(from);
+    int reached = -1;
+    for (size_t head = 0; head < q.size() && reached == -1; head++) {
+        int v = q[head];
+        SOLVER_COUNT(state, arcsScanned, r.getArcEnd(v) - r.getArcBegin(v));
+        for (int a = r.getArcBegin(v); a < r.getArcEnd(v); a++) {
+            const ResidualArc &arc = r.getArc(a);
+            int w = arc.head;
+            if (arc.forward != forward || state.isVisited(w) || state.getFlow(arc.pipe) <= 0)
+                continue;
+            state.setVisited(w);
+            state.setPath(w, a);
+            if (w == to || w == stop) {
+                reached = w;
+                break;
+            }
+            q.push_back(w);
+        }
+    }
+    if (reached == -1)
+        return -1;
+
+    // Walk back from the ServicePoint reached to the start of the search
+    for (int v = reached; v != from; ) {
+        int a = state.getPath(v);
+        pipes.push_back(r.getArc(a).pipe);
+        v = r.getTail(a);
+    }
+    std::reverse(pipes.begin(), pipes.end());
+    return reached;
+}
+
+/**
+ * @brief Removes all the flow of a Pipe by cancelling the flow paths (from s to t) or cycles it belongs to, keeping the
+ * flow valid
+ * @param state - FlowState of the solve
+ * @param r - snapshot of the Graph
+ * @param pipe - Pipe whose flow is cancelled
+ * @param s - source ServicePoint
+ * @param t - target ServicePoint
+ * @details Time Complexity O(K*(S+P)), K = number of paths through the Pipe, S = number of ServicePoints, P = number of Pipes
+ */
+void Management::cancelFlow(FlowState &state, const ResidualGraph &r, int pipe, int s, int t) {
+    if (r.getForwardArc(pipe) == -1)
+        return;
+    std::vector<int> after, before;
+    int u = r.getTail(r.getForwardArc(pipe));
+    int w = r.getArc(r.getForwardArc(pipe)).head;
+    while (state.getFlow(pipe) > 0) {
+        // Follow the flow from w until it reaches t or comes back to u
+        int reached = findFlowPath(state, r, w, t, u, true, after);
+        if (reached == -1)
+            break;
+        if (reached == t) {
+            // Go against the flow from u until it reaches s or w
+            reached = findFlowPath(state, r, u, s, w, false, before);
+            if (reached == -1)
+                break;
+            if (reached == w)
+                after.clear();
+        } else {
+            before.clear();
+        }
+
+        // Cancel the bottleneck along the path or cycle
+        double f = state.getFlow(pipe);
+        for (int p : before) f = std::min(f, state.getFlow(p));
+        for (int p : after) f = std::min(f, state.getFlow(p));
+        state.setFlow(pipe, state.getFlow(pipe) - f);
+        for (int p : before) state.setFlow(p, state.getFlow(p) - f);
+        for (int p : after) state.setFlow(p, state.getFlow(p) - f);
+    }
+}
+
 /**
  * @brief Gets the max flow of a specific City
  * @param citySink
@@ -190,19 +1005,18 @@ std::unordered_map<std::string,int> Management::getMaxFlow() {
  */
 std::pair<std::string,int> Management::getMaxFlowCity(ServicePoint * citySink) {
     int maxflow = 0;
-    Reservoir *superSource = new Reservoir("supersource", "x","0", "SRC", INF);
-    g->addReservoir(superSource);
-    for(ServicePoint* v : g->getReservoirSet()){
-        if (v->getCode() != "SRC") {
-            g->addPipe("SRC", v->getCode(), ((Reservoir*)v)->getMaxDelivery());
-        }
-    }
-    edmondsKarp(superSource,citySink);
+    const ResidualGraph &r = getResidualGraph();
+    deferred = false;
+
+    // The City is the sink, so the super sink is not used
+    state.resize(r);
+    state.setServicePointFailed(r.getSuperSink(), true);
+    maxFlow(state,r,r.getSuperSource(),citySink->getIndex());
+    state.setServicePointFailed(r.getSuperSink(), false);
     for (Pipe *p : citySink->getIncoming()){
-        maxflow += p->getFlow();
+        maxflow += state.getFlow(p);
     }
     maxflow=std::min(maxflow,((City*)citySink)->getDemand());
-    g->removeServicePoint(superSource);
     return std::make_pair(citySink->getCode(),maxflow);
 }
 
@@ -213,9 +1027,7 @@ std::pair<std::string,int> Management::getMaxFlowCity(ServicePoint * citySink) {
  */
 std::unordered_map<std::string,int> Management::getFlowDeficit() {
     std::unordered_map<std::string,int> deficitVector;
-    if(maxFlowCity.empty()){
-        maxFlowCity=getMaxFlow();
-    }
+    ensureBaseline();
     for(auto v: maxFlowCity){
         City* c =(City*)g->findServicePoint(v.first);
         if(c->getDemand()>v.second)
@@ -228,108 +1040,210 @@ std::unordered_map<std::string,int> Management::getFlowDeficit() {
 /**
  * @brief Gets the cities affected by a reservoir fail.
  * @param reservoir
- * @return codes of affected cities and respective old and new flow
- * @details Time Complexity O(S*P²), S = number of ServicePoints, P = number of Pipes
+ * @return codes of affected cities, in code order, and respective old and new flow
+ * @details Time Complexity O(S*P²), or O(F*(S+P)) in incremental mode with F = flow lost, S = number of ServicePoints, P = number of Pipes
  */
 std::vector<std::pair<std::string, flowDiff>> Management::getCitiesAffectedByReservoirFail(ServicePoint * reservoir) {
     std::vector<std::pair<std::string, flowDiff>> affectedCities;
 
-    if (maxFlowCity.empty()) {
-        maxFlowCity=getMaxFlow();
-    }
+    ensureBaseline();
 
-    reservoir->setOperational(false);
-    std::unordered_map<std::string,int> newFlow = getMaxFlow();
+    std::unordered_map<std::string,int> newFlow = getMaxFlowAfterFailure(reservoir, nullptr);
 
-    for (auto it = newFlow.begin(); it != newFlow.end(); ++it) {
-        std::string city = it->first;
+    for (ServicePoint *c : g->getCitiesByCode()) {
+        std::string city = c->getCode();
         int oldFlow = maxFlowCity[city];
-        int newFlow = it->second;
-        if (newFlow < oldFlow) {
-            flowDiff diff = {oldFlow, newFlow};
+        int cityFlow = newFlow[city];
+        if (cityFlow < oldFlow) {
+            flowDiff diff = {oldFlow, cityFlow};
             affectedCities.push_back(std::make_pair(city, diff));
         }
     }
-    reservoir->setOperational(true);
     return affectedCities;
 }
 
 /**
  * @brief Gets the cities affected by a Pipe rupture.
  * @param e pipe ruptured
- * @return codes of affected cities and respective old and new flow
- * @details Time Complexity O(S*P²), S = number of ServicePoints, P = number of Pipes
+ * @return codes of affected cities, in code order, and respective old and new flow
+ * @details Time Complexity O(S*P²), or O(F*(S+P)) in incremental mode with F = flow lost, S = number of ServicePoints, P = number of Pipes
  */
 std::vector<std::pair<std::string, flowDiff>> Management::getCitiesAffectedByPipeRupture(Pipe* e){
-    if(maxFlowCity.empty())
-        maxFlowCity=getMaxFlow();
+    ensureBaseline();
     std::vector<std::pair<std::string, flowDiff>> citiesAffected;
-    e->setOperational(false);
-    if(e->getReverse()!=nullptr)
-        e->getReverse()->setOperational(false);
-    std::unordered_map<std::string,int> newValues=getMaxFlow();
-    for(auto v: g->getCitiesSet()){
+    std::unordered_map<std::string,int> newValues=getMaxFlowAfterFailure(nullptr, e);
+    for(auto v: g->getCitiesByCode()){
         if(maxFlowCity[v->getCode()]>newValues[v->getCode()]){
             flowDiff fd = {maxFlowCity[v->getCode()],newValues[v->getCode()]};
             citiesAffected.push_back(std::make_pair(v->getCode(),fd));
         }
     }
-    e->setOperational(true);
-    if(e->getReverse()!=nullptr)
-        e->getReverse()->setOperational(true);
     return citiesAffected;
 }
 
 /**
  * @brief Gets the Crucial Pipes to a City. Checks if the flow of a City decreases from a Pipe removal.
  * @param sp city
- * @return crucial pipes to city sp and respective old and new flow
- * @details Time Complexity O(S*P²), S = number of ServicePoints, P = number of Pipes
+ * @return crucial pipes to city sp, in order of their ends' codes, and respective old and new flow
+ * @details In incremental mode, a Pipe that carries no baseline flow, or whose flow can be rerouted between its ends
+ * inside the network, leaves the baseline a max flow spread over the Cities as before, so it is crucial to no City and
+ * is not solved. The other Pipes are repaired from the baseline flow.
+ * Time Complexity O(P*(S+P)) for the Pipes ruled out, O(F*(S+P)) for each Pipe repaired, F = flow lost, and
+ * O(S*P²) per Pipe otherwise, S = number of ServicePoints, P = number of Pipes
  */
 std::vector<std::pair<Pipe *,flowDiff>> Management::getCrucialPipesToCity(ServicePoint* sp){
-    if(maxFlowCity.empty())
-        maxFlowCity=getMaxFlow();
+    ensureBaseline();
     std::vector<std::pair<Pipe *,flowDiff>> crucialPipes;
-    for (auto e: g->getPipeSet()) {
-        e->setVisited(false);
-    }
+    const ResidualGraph &r = getResidualGraph();
+    deferred = false;
+    std::vector<bool> seen(g->getPipeIndexBound(), false);
+    state.resize(r);
     for (auto e:g->getPipeSet()){
-        if (e->isVisited())
+        if (seen[e->getIndex()])
             continue;
-        e->setOperational(false);
         if(e->getReverse()!=nullptr)
-            e->getReverse()->setOperational(false);
-        std::unordered_map<std::string,int> newValues=getMaxFlow();
-        if (maxFlowCity[sp->getCode()]>newValues[sp->getCode()]){
-            flowDiff diff = {maxFlowCity[sp->getCode()],newValues[sp->getCode()]};
-            crucialPipes.push_back(std::make_pair(e,diff));
+            seen[e->getReverse()->getIndex()] = true;
+
+        if (incremental) {
+            bool noFlow = baseline.getFlow(e) <= 0 && (e->getReverse() == nullptr || baseline.getFlow(e->getReverse()) <= 0);
+            if (noFlow)
+                continue;
+            restoreBaselineFlow(state, r);
+            if (canBypass(state, r, e))
+                continue;
         }
-        e->setOperational(true);
-        if(e->getReverse()!=nullptr) {
-            e->getReverse()->setOperational(true);
-            e->getReverse()->setVisited(true);
+
+        solveFailure(state, r, nullptr, e);
+        int newFlow = getCityFlow(state, sp);
+        if (maxFlowCity[sp->getCode()]>newFlow){
+            flowDiff diff = {maxFlowCity[sp->getCode()],newFlow};
+            crucialPipes.push_back(std::make_pair(e,diff));
         }
     }
+    std::sort(crucialPipes.begin(), crucialPipes.end(), [](const auto &a, const auto &b) {
+        return pipeLess(a.first, b.first);
+    });
     return crucialPipes;
 }
 
+/**
+ * @brief Checks if the flow of a Pipe (and of its reverse) can be rerouted between its ends without it, through the
+ * residual network and without going through the super source or super sink, so that every City keeps its flow
+ * @param state - FlowState holding the baseline flow, which the rerouted flow is added to
+ * @param r - snapshot of the Graph
+ * @param e - Pipe
+ * @return true if all of its flow was rerouted
+ * @details Time Complexity O(F*(S+P)), F = flow of the Pipe, S = number of ServicePoints, P = number of Pipes
+ */
+bool Management::canBypass(FlowState &state, const ResidualGraph &r, Pipe *e) {
+    SOLVER_PHASE(state, SolverPhase::SOLVE);
+    std::vector<int> servicePoints = {r.getSuperSource(), r.getSuperSink()};
+    std::vector<int> pipes = {e->getIndex()};
+    if (e->getReverse() != nullptr)
+        pipes.push_back(e->getReverse()->getIndex());
+    setFailed(state, servicePoints, pipes, true);
+
+    bool bypassed = true;
+    for (int p : pipes) {
+        double left = state.getFlow(p);
+        if (left <= 0 || r.getForwardArc(p) == -1)
+            continue;
+        int u = r.getTail(r.getForwardArc(p));
+        int w = r.getArc(r.getForwardArc(p)).head;
+        while (left > 0 && findAugmentingPath(state, r, u, w)) {
+            double f = std::min(left, findMinResidualAlongPath(state, r, u, w));
+            augmentFlowAlongPath(state, r, u, w, f);
+            left -= f;
+        }
+        if (left > 0) {
+            bypassed = false;
+            break;
+        }
+    }
+
+    setFailed(state, servicePoints, pipes, false);
+    return bypassed;
+}
+
+/**
+ * @brief Evaluates the failure of every Reservoir, every Station and every Pipe (both directions of a bidirectional
+ * Pipe at once), spread over a work-stealing ThreadPool with a FlowState per worker over the shared Graph. Each
+ * failure is solved like the single failure queries, so both give the same results
+ * @return every failure, ServicePoints before Pipes and each in code order, and the cities it affects, with respective
+ * old and new flow
+ * @details Time Complexity O((R+S+P)*S*P²/W), R = number of Reservoirs, S = number of ServicePoints, P = number of
+ * Pipes, W = number of threads
+ */
+std::vector<contingency> Management::getContingencies() {
+    ensureBaseline();
+
+    std::vector<contingency> contingencies;
+    for (ServicePoint *v : g->getServicePointSet()) {
+        if (dynamic_cast<City *>(v) == nullptr)
+            contingencies.push_back({v, nullptr, {}});
+    }
+    std::sort(contingencies.begin(), contingencies.end(), [](const contingency &a, const contingency &b) {
+        return Graph::codeLess(a.servicePoint->getCode(), b.servicePoint->getCode());
+    });
+    std::size_t servicePointFailures = contingencies.size();
+    std::vector<bool> seen(g->getPipeIndexBound(), false);
+    for (Pipe *e : g->getPipeSet()) {
+        if (seen[e->getIndex()])
+            continue;
+        if (e->getReverse() != nullptr)
+            seen[e->getReverse()->getIndex()] = true;
+        contingencies.push_back({nullptr, e, {}});
+    }
+    std::sort(contingencies.begin() + (long) servicePointFailures, contingencies.end(), [](const contingency &a, const contingency &b) {
+        return pipeLess(a.pipe, b.pipe);
+    });
+    std::vector<ServicePoint *> cities = g->getCitiesByCode();
+
+    // The workers share the Graph, so the elements of each failure are listed by a transaction beforehand
+    const ResidualGraph &r = getResidualGraph();
+    std::vector<std::vector<int>> failedServicePoints(contingencies.size()), failedPipes(contingencies.size());
+    for (std::size_t i = 0; i < contingencies.size(); i++) {
+        GraphTransaction failure(g);
+        takeOutOfOperation(contingencies[i].servicePoint, contingencies[i].pipe);
+        failedServicePoints[i] = failure.getTouchedServicePoints();
+        failedPipes[i] = failure.getTouchedPipes();
+        failure.rollback();
+    }
+    ThreadPool pool;
+    std::vector<FlowState> states(pool.size(), FlowState(r));
+    pool.parallelFor(contingencies.size(), [&](size_t task, unsigned worker) {
+        contingency &c = contingencies[task];
+        FlowState &state = states[worker];
+
+        solveAfterFailure(state, r, failedServicePoints[task], failedPipes[task]);
+        SOLVER_PHASE(state, SolverPhase::TEARDOWN);
+        for (ServicePoint *city : cities) {
+            int newFlow = getCityFlow(state, city);
+            int oldFlow = maxFlowCity.at(city->getCode());
+            if (newFlow < oldFlow)
+                c.citiesAffected.push_back(std::make_pair(city->getCode(), flowDiff{oldFlow, newFlow}));
+        }
+    });
+    for (const FlowState &worker : states) {
+        state.addAugmentations(worker.getAugmentations());
+        state.getStats().add(worker.getStats());
+    }
+    return contingencies;
+}
+
 /**
  * @brief Gets the cities affected by a Station failing
  * @param downStation pumping station failing
- * @return codes of affected cities and respective old and new flow
- * @details Time Complexity O(S*P²), S = number of ServicePoints, P = number of Pipes
+ * @return codes of affected cities, in code order, and respective old and new flow
+ * @details Time Complexity O(S*P²), or O(F*(S+P)) in incremental mode with F = flow lost, S = number of ServicePoints, P = number of Pipes
  */
 std::vector<std::pair<std::string, flowDiff>> Management::getCitiesAffectedByStationFail(ServicePoint* downStation) {
     std::vector<std::pair<std::string, flowDiff>> affectedCities;
-    if (maxFlowCity.empty()){
-        maxFlowCity=getMaxFlow();
-    }
+    ensureBaseline();
 
-    downStation->setOperational(false);
-    std::unordered_map<std::string,int> newFlowCity = getMaxFlow();
-    downStation->setOperational(true);
+    std::unordered_map<std::string,int> newFlowCity = getMaxFlowAfterFailure(downStation, nullptr);
 
-    for (ServicePoint* c : g->getCitiesSet()){
+    for (ServicePoint* c : g->getCitiesByCode()){
         int diff = newFlowCity[c->getCode()] - maxFlowCity[c->getCode()];
         if (diff < 0){
             flowDiff fd = {maxFlowCity[c->getCode()], newFlowCity[c->getCode()]};
@@ -340,182 +1254,225 @@ std::vector<std::pair<std::string, flowDiff>> Management::getCitiesAffectedBySta
 }
 
 /**
- * @brief Get average pipe pressure (%) of current graph
+ * @brief Loads the baseline max flow from a results file, so the failure analyses do not compute it again. The
+ * cached scenarios are dropped, since they may have been repaired from another baseline flow
+ * @param path
+ * @return false if the file is missing or was computed for another network or algorithm
+ * @details Time Complexity O(S+P), S = number of ServicePoints, P = number of Pipes
+ */
+bool Management::loadBaseline(const std::string &path) {
+    const ResidualGraph &r = getResidualGraph();
+    if (!ResultStore::load(path, ResultStore::hashNetwork(g, (uint32_t) algorithm), r, baseline))
+        return false;
+    maxFlowCity = getFlowPerCity(baseline);
+    scenarios.clear();
+    return true;
+}
+
+/**
+ * @brief Writes the baseline max flow to a results file, computing it first if needed
+ * @param path
+ * @return false if the file could not be written
+ * @details Time Complexity O(S+P), or O(S*P²) if the baseline is computed, S = number of ServicePoints,
+ * P = number of Pipes
+ */
+bool Management::saveBaseline(const std::string &path) {
+    ensureBaseline();
+    return ResultStore::save(path, ResultStore::hashNetwork(g, (uint32_t) algorithm), getResidualGraph(), baseline);
+}
+
+/**
+ * @brief Get average pipe pressure (%) of the flow of the last query
  * @return average pipe pressure (%)
  */
 float Management::getAveragePipePressure() {
+    solveDeferred();
     float totalPressure = 0;
     int pipeCount = 0;
+    state.resize(getResidualGraph());
+    sumPipePressure(state, totalPressure, pipeCount);
+    return ( totalPressure / pipeCount );
+}
+
+/**
+ * @brief Adds the pressure of every Pipe to a sum, the higher one for both directions of a bidirectional Pipe
+ * @param state - FlowState of the solve
+ * @param totalPressure - sum of the pressures
+ * @param pipeCount - number of pressures added
+ */
+void Management::sumPipePressure(const FlowState &state, float &totalPressure, int &pipeCount) {
+    std::vector<bool> seen(g->getPipeIndexBound(), false);
     for (Pipe* p : g->getPipeSet()) {
-        p->setVisited(false);
-    }
-    for (Pipe* p : g->getPipeSet()) {
-        if (p->isVisited())
+        if (seen[p->getIndex()])
             continue;
         pipeCount++;
         if (p->getReverse() != nullptr) {
-            p->getReverse()->setVisited(true);
-            totalPressure += std::max(p->getPressure(), p->getReverse()->getPressure());
+            seen[p->getReverse()->getIndex()] = true;
+            totalPressure += std::max(state.getPressure(p), state.getPressure(p->getReverse()));
         } else {
-            totalPressure += p->getPressure();
+            totalPressure += state.getPressure(p);
         }
     }
-    return ( totalPressure / pipeCount );
 }
 
 /**
- * @brief Get pipe pressure variance (%) of current graph
+ * @brief Get pipe pressure variance (%) of the flow of the last query
  * @return pipe pressure variance (%)
  */
 float Management::getVariancePipePressure() {
+    solveDeferred();
     float totalSquaredPressure = 0;
     float totalPressure = 0;
     int pipeCount = 0;
+    state.resize(getResidualGraph());
+    std::vector<bool> seen(g->getPipeIndexBound(), false);
     for (Pipe* p : g->getPipeSet()) {
-        p->setVisited(false);
-    }
-    for (Pipe* p : g->getPipeSet()) {
-        if (p->isVisited())
+        if (seen[p->getIndex()])
           continue;
         pipeCount++;
         if (p->getReverse() != nullptr) {
-            p->getReverse()->setVisited(true);
-            float pipePressure = std::max(p->getPressure(), p->getReverse()->getPressure());
+            seen[p->getReverse()->getIndex()] = true;
+            float pipePressure = std::max(state.getPressure(p), state.getPressure(p->getReverse()));
             totalPressure += pipePressure;
             totalSquaredPressure += (pipePressure * pipePressure);
         } else {
-            totalSquaredPressure += (p->getPressure() * p->getPressure());
-            totalPressure += p->getPressure();
+            totalSquaredPressure += (state.getPressure(p) * state.getPressure(p));
+            totalPressure += state.getPressure(p);
         }
     }
     return ( (totalSquaredPressure - ( (totalPressure * totalPressure) / g->getPipeSet().size() ) ) / (pipeCount) );
 }
 
 
+/**
+ * @brief Gets the residual capacity of an arc, with the forward arcs limited by the capacity caps (used for balancing algorithm)
+ * @param state - FlowState of the solve
+ * @param r - snapshot of the Graph
+ * @param a - arc
+ * @return residual capacity, 0 if its Pipe or the ServicePoint it enters failed
+ * @details Time Complexity O(1)
+ */
+double Management::getResidualBalance(const FlowState &state, const ResidualGraph &r, int a) {
+    const ResidualArc &arc = r.getArc(a);
+    if (state.isPipeFailed(arc.pipe) || state.isServicePointFailed(arc.head))
+        return 0;
+    if (!arc.forward)
+        return state.getFlow(arc.pipe);
+    return std::min(r.getCapacity(arc.pipe), state.getCapacityCap(arc.pipe)) - state.getFlow(arc.pipe);
+}
+
 /**
  * @brief Finds an augmenting path using Breadth-First Search (used for balancing algorithm)
+ * @param state - FlowState of the solve
+ * @param r - snapshot of the Graph
  * @param s - source ServicePoint
  * @param t - target ServicePoint
  * @return True if path is found
  * @details Time Complexity O(S+P) and O(P*log(P)) if balanced, S = number of ServicePoints, P = number of Pipes
  */
-bool Management::findAugmentingPathBalance( ServicePoint *s, ServicePoint *t) {
+bool Management::findAugmentingPathBalance(FlowState &state, const ResidualGraph &r, int s, int t) {
+    auto pressure = [&](int a) {
+        int p = r.getArc(a).pipe;
+        return (float) (state.getFlow(p) / r.getCapacity(p));
+    };
+
     // Mark all vertices as not visited
-    for(ServicePoint*v:g->getServicePointSet()){
-        v->setVisited(false);
-    }
+    state.clearVisited();
+    SOLVER_COUNT(state, searches, 1);
 
     // Mark the source ServicePoint as visited and enqueue it
-    s->setVisited(true);
-    std::queue<ServicePoint*> q;
-    q.push(s);
+    state.setVisited(s);
+    std::vector<int> &q = state.getQueue();
+    q.push_back(s);
 
     // BFS to find an augmenting path
-    while(!q.empty() && !t->isVisited()){
-        auto v=q.front();
-        q.pop();
-        if(!v->isOperational())
+    std::vector<int> arcs;
+    std::vector<int> inArcs;
+    for(size_t head=0; head<q.size() && !state.isVisited(t); head++){
+        int v=q[head];
+        if(state.isServicePointFailed(v))
             continue;
 
-        std::vector<Pipe*> pipes = v->getAdj();
-        std::vector<Pipe*> inpipes = v->getIncoming();
+        arcs.clear();
+        inArcs.clear();
+        SOLVER_COUNT(state, arcsScanned, r.getArcEnd(v) - r.getArcBegin(v));
+        for (int a = r.getArcBegin(v); a < r.getArcEnd(v); a++) {
+            (r.getArc(a).forward ? arcs : inArcs).push_back(a);
+        }
 
-        std::sort(pipes.begin(), pipes.end(), [](Pipe *a, Pipe *b) {
-            return a->getPressure() < b->getPressure();
+        std::sort(arcs.begin(), arcs.end(), [&pressure](int a, int b) {
+            return pressure(a) < pressure(b);
         });
-        std::sort(inpipes.begin(), inpipes.end(), [](Pipe *a, Pipe *b) {
-            return a->getPressure() > b->getPressure();
+        std::sort(inArcs.begin(), inArcs.end(), [&pressure](int a, int b) {
+            return pressure(a) > pressure(b);
         });
 
         // Process incoming Pipes, they reduce pressure of pipe
-        for (Pipe *e: inpipes) {
-            testAndVisit(q, e, e->getOrig(), e->getFlow());
+        for (int a: inArcs) {
+            testAndVisit(state, q, a, r.getArc(a).head, getResidualBalance(state, r, a));
         }
         // Process outgoing Pipes, they increase pressure on pipe
-        for (Pipe *e: pipes) {
-            testAndVisit(q, e, e->getDest(), e->getCapacityCap() - e->getFlow());
+        for (int a: arcs) {
+            testAndVisit(state, q, a, r.getArc(a).head, getResidualBalance(state, r, a));
         }
     }
     // Return true if a path to the target is found, false otherwise
-    return t->isVisited();
+    return state.isVisited(t);
 }
 
 /**
  * @brief Find the minimum residual capacity along the augmenting path (used for balancing algorithm)
+ * @param state - FlowState of the solve
+ * @param r - snapshot of the Graph
  * @param s - source ServicePoint
  * @param t - target ServicePoint
  * @return f
  * @details Time Complexity O(P) P = number of Pipes between s and t
  */
-double Management::findMinResidualAlongPathBalance(ServicePoint *s, ServicePoint *t) {
+double Management::findMinResidualAlongPathBalance(FlowState &state, const ResidualGraph &r, int s, int t) {
     double f = INF;
     // Traverse the augmenting path to find the minimum residual capacity
-    ServicePoint *v=t;
+    int v=t;
     while(v!=s){
-        auto e=v->getPath();
-        if(e->getDest()==v){
-            f=std::min(f,e->getCapacityCap()-e->getFlow());
-            v=e->getOrig();
+        int a=state.getPath(v);
+        const ResidualArc &arc = r.getArc(a);
+        if(arc.forward){
+            f=std::min(f,std::min(r.getCapacity(arc.pipe),state.getCapacityCap(arc.pipe))-state.getFlow(arc.pipe));
         }
         else{
-            f=std::min(f,e->getFlow());
-            v=e->getDest();
+            f=std::min(f,state.getFlow(arc.pipe));
         }
+        v=r.getTail(a);
     }
     // Return the minimum residual capacity
     return f;
 }
 
-/**
- * @brief Augments the flow along the augmenting path with the given flow value (used for balancing algorithm)
- * @param s - source ServicePoint
- * @param t - target ServicePoint
- * @param f - flow value
- * @details Time Complexity O(P) P = number of Pipes between s and t
- */
-void Management::augmentFlowAlongPathBalance(ServicePoint *s, ServicePoint *t, double f) {
-    ServicePoint *v=t;
-    while(v!=s){
-        auto e=v->getPath();
-        double flow=e->getFlow();
-        if(e->getDest()==v){
-            e->setFlow(flow+f);
-            v=e->getOrig();
-        }
-        else{
-            e->setFlow(flow-f);
-            v=e->getDest();
-        }
-    }
-}
-
 /**
  * @brief Performs the EdmondsKarp (used for balancing algorithm)
+ * @param state - FlowState of the solve
+ * @param r - snapshot of the Graph
  * @param s - source ServicePoint
  * @param t - target ServicePoint
+ * @param reset - start from a null flow, otherwise keep augmenting the current (valid) flow
  * @details Time Complexity O(S*P²), S = number of ServicePoints, P = number of Pipes
  */
-void Management::edmondsKarpBalance( ServicePoint* s, ServicePoint* t, bool reset) {
+void Management::edmondsKarpBalance(FlowState &state, const ResidualGraph &r, int s, int t, bool reset) {
 
     // Validate source and target vertices
-    if(s==nullptr || t== nullptr || s==t){
+    if(s<0 || t<0 || s==t){
         throw std::logic_error("Invalid source and/or target ServicePoint");
     }
 
     // Initialize flow on all Pipes to 0
     if (reset) {
-        for (ServicePoint *v: g->getServicePointSet()) {
-            v->setPath(nullptr);
-            for (Pipe *e: v->getAdj()) {
-                e->setFlow(0);
-            }
-        }
+        state.reset();
     }
 
     // While there is an augmenting path, augment the flow along the path
-    while(findAugmentingPathBalance(s,t)){
-        double f = findMinResidualAlongPathBalance(s,t);
-        augmentFlowAlongPathBalance(s,t,f);
+    while(findAugmentingPathBalance(state,r,s,t)){
+        double f = findMinResidualAlongPathBalance(state,r,s,t);
+        augmentFlowAlongPath(state,r,s,t,f);
     }
 }
 
@@ -525,35 +1482,20 @@ void Management::edmondsKarpBalance( ServicePoint* s, ServicePoint* t, bool rese
  * @details Time Complexity O(S*P²), S = number of ServicePoints, P = number of Pipes
  */
 std::unordered_map<std::string,int> Management::getMaxFlowBalance() {
-    Reservoir *superSource = new Reservoir("supersource", "x","0", "SRC", INF);
-    g->addReservoir(superSource);
-    for(ServicePoint* v:g->getReservoirSet()){
-        if (v->getCode() != "SRC") {
-            g->addPipe("SRC", v->getCode(), ((Reservoir*)v)->getMaxDelivery());
-        }
-    }
-    City *superSink = new City("supersink","01","SINK",INF,INF);
-    g->addCity(superSink);
-    for(ServicePoint* v:g->getCitiesSet()){
-        if (v->getCode() != "SINK") {
-            g->addPipe(v->getCode(), "SINK", ((City*)v)->getDemand());
-        }
-    }
+    const ResidualGraph &r = getResidualGraph();
+    deferred = false;
 
     // run the first full max flow
-    edmondsKarp(superSource,superSink);
+    maxFlow(state,r,r.getSuperSource(),r.getSuperSink());
 
-    closeToAvg(superSource, superSink);
+    closeToAvg(state, r);
 
+    SOLVER_PHASE(state, SolverPhase::TEARDOWN);
     std::unordered_map<std::string,int> flowPerCity;
-    g->removeServicePoint(superSource);
-    g->removeServicePoint(superSink);
     for(ServicePoint* v: g->getCitiesSet()){
-        if (v->getCode() == "SINK")
-            continue;
         double maxflow=0;
         for(Pipe* e: v->getIncoming()){
-            maxflow+= e->getFlow();
+            maxflow+= state.getFlow(e);
         }
         flowPerCity.insert(std::make_pair(v->getCode(),maxflow));
     }
@@ -562,30 +1504,53 @@ std::unordered_map<std::string,int> Management::getMaxFlowBalance() {
 
 /**
  * @brief Reduces the capacity of overpressured pipes to the average pressure
- * @param superSource super source
- * @param superSink super sink
+ * @param state - FlowState of the solve, holding a max flow
+ * @param r - snapshot of the Graph
  * @return flowPerCity
  * @details Time Complexity O(S*P²), S = number of ServicePoints, P = number of Pipes
  */
-void Management::closeToAvg(ServicePoint *superSource, ServicePoint *superSink) {
+void Management::closeToAvg(FlowState &state, const ResidualGraph &r) {
+    SOLVER_PHASE(state, SolverPhase::SOLVE);
+    TRACE_SCOPE("balance", "closeToAvg");
+    int s = r.getSuperSource();
+    int t = r.getSuperSink();
+
+    // average pressure, counting the super source and super sink Pipes too
+    float totalPressure = 0;
+    int pipeCount = 0;
+    double avg;
+    {
+        TRACE_SCOPE("balance", "average pressure");
+        sumPipePressure(state, totalPressure, pipeCount);
+        for (int v : {s, t}) {
+            for (int a = r.getArcBegin(v); a < r.getArcEnd(v); a++) {
+                int p = r.getArc(a).pipe;
+                totalPressure += (float) (state.getFlow(p) / r.getCapacity(p));
+                pipeCount++;
+            }
+        }
+        avg = totalPressure / pipeCount;
+    }
+
     // reduce capacity to average
-    double avg = getAveragePipePressure();
     for(Pipe* e: g->getPipeSet()){
-        if (e->getDest()->getCode() == "SINK" || e->getOrig()->getCode() == "SRC")
-            continue;
-        if (e->getFlow() > avg) {
-            e->setCapacityCap(e->getCapacity() * avg);
+        if (state.getFlow(e) > avg) {
+            state.setCapacityCap(e, e->getCapacity() * avg);
         }
     }
 
     // run max flow with cap
-    edmondsKarpBalance(superSource, superSink);
+    {
+        TRACE_SCOPE("balance", "capped pass");
+        edmondsKarpBalance(state, r, s, t);
+    }
 
     // reestablish full capacity
-    for (Pipe * p : g->getPipeSet()) {
-        p->setCapacityCap(p->getCapacity());
-    }
+    state.clearCapacityCaps();
 
     // continue previous max flow
-    edmondsKarpBalance(superSource, superSink, false);
-}
\ No newline at end of file
+    {
+        TRACE_SCOPE("balance", "full capacity pass");
+        edmondsKarpBalance(state, r, s, t, false);
+    }
+}
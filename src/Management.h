@@ -1,6 +1,9 @@
 #ifndef PROJECT1_MANAGEMENT_H
 #define PROJECT1_MANAGEMENT_H
 #include "Graph.h"
+#include "FlowState.h"
+#include "ResidualGraph.h"
+#include "ScenarioCache.h"
 #include <queue>
 
 /**
@@ -11,31 +14,108 @@ struct flowDiff{
     int newFlow;
 };
 
+/**
+ * @brief Auxiliary struct containing a failure and the cities it affects
+ */
+struct contingency {
+    ServicePoint *servicePoint; // Reservoir or Station that fails, nullptr if it is a Pipe
+    Pipe *pipe; // Pipe that ruptures, nullptr if it is a ServicePoint
+    std::vector<std::pair<std::string, flowDiff>> citiesAffected;
+};
+
+/**
+ * @brief Max flow algorithms that can answer the Management queries
+ */
+enum class FlowAlgorithm {
+    EDMONDS_KARP,
+    DINIC,
+    PUSH_RELABEL
+};
+
 /**
  * @brief Management manages and answers the requests from the Menu
+ * @details Every algorithm reads the Graph and keeps its flow, visits and failures in a FlowState. Failure analyses
+ * take the failed elements out of operation inside a GraphTransaction and roll it back, so every query leaves the
+ * Graph, and its version, as it found it
  */
 class Management {
 private:
     Graph* g;
+    ResidualGraph residual; // snapshot of the Graph the engines run on
     std::unordered_map<std::string,int> maxFlowCity;
+    FlowState state; // flow of the last query, unless it is deferred
+    FlowState baseline; // flow of the first overall max flow, valid if maxFlowCity is not empty
+    ScenarioCache scenarios; // flow per City of recent failures
+    bool deferred = false; // the last query was answered from the cache and its flow is not in state
+    ServicePoint *deferredServicePoint = nullptr;
+    Pipe *deferredPipe = nullptr;
+    unsigned long deferredVersion = 0; // Graph version of the deferred failure
+    FlowAlgorithm algorithm = FlowAlgorithm::EDMONDS_KARP;
+    bool incremental = true;
 public:
     Management(Graph * graph);
 
+    void setAlgorithm(FlowAlgorithm algorithm);
+    FlowAlgorithm getAlgorithm() const;
+    void setIncremental(bool incremental);
+    bool isIncremental() const;
+    const ResidualGraph & getResidualGraph();
+    void maxFlow(FlowState &state, const ResidualGraph &r, int s, int t, bool reset=true);
+
     // Auxiliary functions to max flow algorithm
-    void testAndVisit(std::queue<ServicePoint*> &q, Pipe*e, ServicePoint *w, double residual);
-    bool findAugmentingPath( ServicePoint *s, ServicePoint *t);
-    double findMinResidualAlongPath(ServicePoint *s, ServicePoint *t);
-    void edmondsKarp( ServicePoint* s, ServicePoint* t);
-    void augmentFlowAlongPath(ServicePoint *s, ServicePoint *t, double f);
+    double getResidual(const FlowState &state, const ResidualGraph &r, int a);
+    void testAndVisit(FlowState &state, std::vector<int> &q, int a, int w, double residual);
+    bool findAugmentingPath(FlowState &state, const ResidualGraph &r, int s, int t);
+    double findMinResidualAlongPath(FlowState &state, const ResidualGraph &r, int s, int t);
+    void augmentFlowAlongPath(FlowState &state, const ResidualGraph &r, int s, int t, double f);
+    void edmondsKarp(FlowState &state, const ResidualGraph &r, int s, int t, bool reset=true);
+
+    // Dinic max flow algorithm
+    bool buildLevelGraph(FlowState &state, const ResidualGraph &r, int s, int t);
+    bool isLevelArc(const FlowState &state, const ResidualGraph &r, int v, int a);
+    void sendBlockingFlow(FlowState &state, const ResidualGraph &r, int s, int t);
+    void dinic(FlowState &state, const ResidualGraph &r, int s, int t, bool reset=true);
+
+    // Push-relabel max flow algorithm
+    void globalRelabel(FlowState &state, const ResidualGraph &r, int s, int t, std::vector<int> &heightCount);
+    void relabel(FlowState &state, const ResidualGraph &r, int v, std::vector<int> &heightCount);
+    int discharge(FlowState &state, const ResidualGraph &r, int v, int s, int t, std::queue<int> &active, std::vector<int> &heightCount);
+    void pushRelabel(FlowState &state, const ResidualGraph &r, int s, int t, bool reset=true);
 
     // Balancing the network
-    bool findAugmentingPathBalance( ServicePoint *s, ServicePoint *t);
-    double findMinResidualAlongPathBalance(ServicePoint *s, ServicePoint *t);
-    void edmondsKarpBalance( ServicePoint* s, ServicePoint* t, bool reset=true);
-    void augmentFlowAlongPathBalance(ServicePoint *s, ServicePoint *t, double f);
+    double getResidualBalance(const FlowState &state, const ResidualGraph &r, int a);
+    bool findAugmentingPathBalance(FlowState &state, const ResidualGraph &r, int s, int t);
+    double findMinResidualAlongPathBalance(FlowState &state, const ResidualGraph &r, int s, int t);
+    void edmondsKarpBalance(FlowState &state, const ResidualGraph &r, int s, int t, bool reset=true);
     std::unordered_map<std::string,int> getMaxFlowBalance();
-    void closeToAvg(ServicePoint *superSource, ServicePoint *superSink);
+    void closeToAvg(FlowState &state, const ResidualGraph &r);
 
+    // Flow reaching the Cities
+    std::unordered_map<std::string,int> getFlowPerCity(const FlowState &state);
+    int getCityFlow(const FlowState &state, ServicePoint *city);
+
+    // Incremental repair of the baseline flow after a failure
+    std::unordered_map<std::string,int> getMaxFlowAfterFailure(ServicePoint *failedServicePoint, Pipe *failedPipe);
+    ScenarioCache::Scenario getScenario(ServicePoint *failedServicePoint, Pipe *failedPipe) const;
+    void solveDeferred();
+    ScenarioCache & getScenarioCache();
+    unsigned long getAugmentations() const;
+    const SolverStats & getSolverStats() const;
+    void resetSolverStats();
+    MemoryReport getMemoryReport() const;
+    void spreadOverCities(FlowState &state, const ResidualGraph &r);
+    void solveFailure(FlowState &state, const ResidualGraph &r, ServicePoint *failedServicePoint, Pipe *failedPipe);
+    void takeOutOfOperation(ServicePoint *failedServicePoint, Pipe *failedPipe);
+    void solveAfterFailure(FlowState &state, const ResidualGraph &r, const std::vector<int> &failedServicePoints,
+                           const std::vector<int> &failedPipes);
+    void setFailed(FlowState &state, const std::vector<int> &failedServicePoints, const std::vector<int> &failedPipes, bool failed);
+    void restoreBaselineFlow(FlowState &state, const ResidualGraph &r);
+    void repairFlow(FlowState &state, const ResidualGraph &r, const std::vector<int> &failedServicePoints,
+                    const std::vector<int> &failedPipes);
+    int findFlowPath(FlowState &state, const ResidualGraph &r, int from, int to, int stop, bool forward, std::vector<int> &pipes);
+    void cancelFlow(FlowState &state, const ResidualGraph &r, int pipe, int s, int t);
+
+    void ensureBaseline();
     std::unordered_map<std::string,int> getMaxFlow();
     std::pair<std::string,int> getMaxFlowCity(ServicePoint * citySink);
     std::unordered_map<std::string,int> getFlowDeficit ();
@@ -43,10 +123,17 @@ public:
     std::vector<std::pair<std::string, flowDiff>> getCitiesAffectedByStationFail(ServicePoint* downStation);
     std::vector<std::pair<std::string, flowDiff>> getCitiesAffectedByPipeRupture(Pipe* e);
     std::vector<std::pair<Pipe *,flowDiff>> getCrucialPipesToCity(ServicePoint* sp);
+    bool canBypass(FlowState &state, const ResidualGraph &r, Pipe *e);
+    std::vector<contingency> getContingencies();
+
+    // Precomputed results
+    bool loadBaseline(const std::string &path);
+    bool saveBaseline(const std::string &path);
 
     // Metrics
     float getAveragePipePressure();
     float getVariancePipePressure();
+    void sumPipePressure(const FlowState &state, float &totalPressure, int &pipeCount);
 };
 
 #endif //PROJECT1_MANAGEMENT_H
@@ -0,0 +1,55 @@
+#include "MappedFile.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief MappedFile Constructor, maps the file at path
+ * @param path
+ */
+MappedFile::MappedFile(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+        return;
+    struct stat info{};
+    if (fstat(fd, &info) == 0) {
+        open = true;
+        size = (std::size_t) info.st_size;
+        if (size > 0) {
+            void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                open = false;
+                size = 0;
+            } else {
+                data = (const char *) mapping;
+                madvise(mapping, size, MADV_SEQUENTIAL);
+            }
+        }
+    }
+    close(fd);
+}
+
+/**
+ * @brief MappedFile Destructor, unmaps the file
+ */
+MappedFile::~MappedFile() {
+    if (data != nullptr)
+        munmap((void *) data, size);
+}
+
+/**
+ * @brief Checks if the file was opened and mapped
+ * @return open
+ */
+bool MappedFile::isOpen() const {
+    return open;
+}
+
+/**
+ * @brief Gets the contents of the file, valid while the MappedFile lives
+ * @return contents
+ */
+std::string_view MappedFile::getContents() const {
+    return {data, size};
+}
@@ -0,0 +1,29 @@
+#ifndef PROJECT1_MAPPEDFILE_H
+#define PROJECT1_MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Read-only memory mapping of a whole file
+ * @details The pages are loaded by the kernel as they are read, with no copy into a user buffer. A file that cannot
+ * be opened is seen as empty, like an std::ifstream that failed to open.
+ */
+class MappedFile {
+public:
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+
+    bool isOpen() const;
+    std::string_view getContents() const;
+
+private:
+    const char *data = nullptr;
+    std::size_t size = 0;
+    bool open = false;
+};
+
+#endif //PROJECT1_MAPPEDFILE_H
@@ -0,0 +1,46 @@
+#include <sys/resource.h>
+#include <iomanip>
+#include "MemoryReport.h"
+
+/**
+ * @brief Gets the bytes of every category
+ * @return bytes
+ */
+std::size_t MemoryReport::total() const {
+    return nodes + pipes + adjacency + indexes + strings + solverScratch;
+}
+
+/**
+ * @brief Prints the size of every category in KiB on one line
+ * @param out
+ */
+void MemoryReport::print(std::ostream &out) const {
+    std::ios_base::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(1) << "Memory: nodes " << nodes / 1024.0 << " KiB, pipes "
+        << pipes / 1024.0 << " KiB, adjacency " << adjacency / 1024.0 << " KiB, indexes " << indexes / 1024.0
+        << " KiB, strings " << strings / 1024.0 << " KiB, solver scratch " << solverScratch / 1024.0
+        << " KiB, total " << total() / 1024.0 << " KiB; peak RSS " << peakRssKb << " KiB\n";
+    out.flags(flags);
+}
+
+/**
+ * @brief Gets the largest resident set size the process reached so far
+ * @return KiB
+ */
+long MemoryReport::getPeakRssKb() {
+    struct rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/**
+ * @brief Gets the heap bytes of a string
+ * @param s
+ * @return bytes, 0 if the string fits inside its object
+ */
+std::size_t MemoryReport::stringBytes(const std::string &s) {
+    const char *object = reinterpret_cast<const char *>(&s);
+    if (s.data() >= object && s.data() < object + sizeof(s))
+        return 0;
+    return s.capacity() + 1;
+}
@@ -0,0 +1,42 @@
+#ifndef PROJECT1_MEMORYREPORT_H
+#define PROJECT1_MEMORYREPORT_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Bytes held by a network and its solver state, by category, along with the peak resident set size of the
+ * process
+ * @details The bytes are estimated from the sizes of the objects and the capacities of their containers, so they
+ * leave out the bookkeeping of the allocator. Strings only count their heap buffer, short ones live inside their
+ * object.
+ */
+struct MemoryReport {
+    std::size_t nodes = 0; // ServicePoint objects
+    std::size_t pipes = 0; // Pipe objects
+    std::size_t adjacency = 0; // outgoing and incoming Pipes of every ServicePoint
+    std::size_t indexes = 0; // sets, positions, lookups and symbol tables of the Graph
+    std::size_t strings = 0; // codes, names and ids
+    std::size_t solverScratch = 0; // residual graph and flow states
+    long peakRssKb = 0;
+
+    std::size_t total() const;
+    void print(std::ostream &out) const;
+
+    static long getPeakRssKb();
+    static std::size_t stringBytes(const std::string &s);
+
+    /**
+     * @brief Gets the bytes of the buffer of a vector
+     * @param v
+     * @return bytes
+     */
+    template <typename T>
+    static std::size_t vectorBytes(const std::vector<T> &v) {
+        return v.capacity() * sizeof(T);
+    }
+};
+
+#endif //PROJECT1_MEMORYREPORT_H
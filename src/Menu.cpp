@@ -5,6 +5,8 @@
 #include <fstream>
 #include "Menu.h"
 #include "Auxiliar.h"
+#include "Snapshot.h"
+#include "TraceRecorder.h"
 
 
 /**
@@ -24,6 +26,72 @@ void Menu::run(){
     system("clear");
 }
 
+/**
+ * @brief Takes the baseline max flow from a results file when it matches the network, otherwise computes it and
+ * writes the file for the next run
+ * @param path results file
+ */
+void Menu::usePrecomputedResults(const std::string &path) {
+    if (!m.loadBaseline(path) && !m.saveBaseline(path))
+        std::cerr << "Could not write the results file " << path << "\n";
+}
+
+/**
+ * @brief Sets the files of the dataset loaded at start, which are applied again to each dataset chosen later
+ * @param dataset - dataset loaded at start, or -1 if it was read from another directory
+ * @param loadPath - snapshot the network is loaded from, or empty
+ * @param savePath - snapshot the network is written to, or empty
+ * @param results - results file of the baseline max flow, or empty
+ */
+void Menu::setDatasetFiles(int dataset, const std::string &loadPath, const std::string &savePath, const std::string &results) {
+    startDataset = dataset;
+    if (dataset >= 0)
+        curDataset = dataset;
+    snapshotLoadPath = loadPath;
+    snapshotSavePath = savePath;
+    resultsPath = results;
+}
+
+/**
+ * @brief Gets the path of a file of the current dataset: the path given at start for the dataset loaded then,
+ * followed by the dataset number for the others, so that each dataset keeps its own file
+ * @param path
+ * @return path of the current dataset
+ */
+std::string Menu::datasetPath(const std::string &path) const {
+    return curDataset == startDataset ? path : path + "." + std::to_string(curDataset);
+}
+
+/**
+ * @brief Reads the current dataset into the Graph from its snapshot when there is one, otherwise from the CSV files,
+ * and writes its snapshot if asked to
+ */
+void Menu::loadDataset() {
+    if (snapshotLoadPath.empty() || !Snapshot::load(g, datasetPath(snapshotLoadPath)))
+        Auxiliar::readDataset(g, curDataset);
+    if (!snapshotSavePath.empty() && !Snapshot::save(g, datasetPath(snapshotSavePath)))
+        std::cerr << "Could not write the snapshot " << datasetPath(snapshotSavePath) << "\n";
+}
+
+/**
+ * @brief Sets whether every query is followed by the memory held by the network and the solver, and the peak
+ * resident set size
+ * @param report
+ */
+void Menu::setMemoryReport(bool report) {
+    memoryReport = report;
+}
+
+/**
+ * @brief Prints what the last query cost: the solver counters, when the project is configured with
+ * PROJECT1_SOLVER_STATS, and the memory report, when it was asked for
+ */
+void Menu::printQueryStats() {
+    m.getSolverStats().print(std::cout);
+    if (memoryReport)
+        m.getMemoryReport().print(std::cout);
+}
+
 /**
  * @brief Clears output file
  */
@@ -50,7 +118,10 @@ void Menu::printMainMenu() {
               << "\t5 - Cities affected by a pumping station failure" << "\n"
               << "\t6 - Crucial pipelines to a city" << "\n"
               << "\t7 - Cities affected by pipeline rupture" << "\n\n"
-              << "8 - Choose dataset (current: " << datasets[curDataset] << ")" << "\n\n";
+              << "8 - Choose dataset (current: " << datasets[curDataset] << ")" << "\n"
+              << "9 - Choose max flow algorithm (current: " << algorithms[(int) m.getAlgorithm()] << ")" << "\n"
+              << "10 - Toggle incremental failure analysis (current: " << (m.isIncremental() ? "on" : "off") << ")" << "\n"
+              << "11 - Cities affected by every reservoir, station and pipeline failure" << "\n\n";
 
     printExit();
     std::cout << "Press the number corresponding the action you want." << "\n";
@@ -67,6 +138,7 @@ void Menu::waitMenu(){
         return;
     system("clear");
     printingOptions options;
+    m.resetSolverStats();
     switch (stoi(choice)) {
         // Maximum amount of water that can reach a city
         case 0: {
@@ -149,8 +221,42 @@ void Menu::waitMenu(){
             std::cout << "\t1 - Large Dataset\n";
             std::cin >> curDataset;
             g = new Graph();
-            Auxiliar::readDataset(g, curDataset);
+            loadDataset();
+            FlowAlgorithm algorithm = m.getAlgorithm();
+            bool incremental = m.isIncremental();
             m = Management(g);
+            m.setAlgorithm(algorithm);
+            m.setIncremental(incremental);
+            if (!resultsPath.empty())
+                usePrecomputedResults(datasetPath(resultsPath));
+            printMainMenu();
+            break;
+        }
+        // Choose max flow algorithm
+        case 9: {
+            std::cout << "Choose what max flow algorithm to use:\n";
+            std::cout << "\t0 - Edmonds-Karp\n";
+            std::cout << "\t1 - Dinic\n";
+            std::cout << "\t2 - Push-Relabel\n";
+            int algorithm;
+            std::cin >> algorithm;
+            if (algorithm >= 0 && algorithm < 3)
+                m.setAlgorithm((FlowAlgorithm) algorithm);
+            printMainMenu();
+            break;
+        }
+        // Toggle incremental failure analysis
+        case 10: {
+            m.setIncremental(!m.isIncremental());
+            printMainMenu();
+            break;
+        }
+        // Cities affected by every reservoir, station and pipeline failure
+        case 11: {
+            std::vector<contingency> contingencies = m.getContingencies();
+            options.message = "Cities affected by every reservoir, station and pipeline failure\n\n";
+            printContingencies(contingencies, options);
+            break;
         }
         default: {
             printMainMenu();
@@ -239,11 +345,13 @@ Pipe * Menu::choosePipeInput() {
 
 
 /**
- * @brief Prints in a tabular form the code of the city and the respective flow, as well as the total in the end
+ * @brief Prints in a tabular form, in code order, the code of the city and the respective flow, as well as the total in
+ * the end
  * @param flowCities Hashmap that contains the flow per city
  * @param options Printing options
  */
 void Menu::printFlowPerCity(std::unordered_map<std::string,int> flowCities, printingOptions options) {
+    TraceScope formatSpan("format", "printFlowPerCity");
     std::ostringstream oss;
 
     if (options.clear)
@@ -260,7 +368,11 @@ void Menu::printFlowPerCity(std::unordered_map<std::string,int> flowCities, prin
 
     // CITIES AND FLOWS
     int total = 0;
-    for (auto it = flowCities.begin(); it != flowCities.end(); it++) {
+    std::vector<std::pair<std::string,int>> sorted(flowCities.begin(), flowCities.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) {
+        return Graph::codeLess(a.first, b.first);
+    });
+    for (auto it = sorted.begin(); it != sorted.end(); it++) {
         total += it->second;
         oss << "|" << center(it->first, ' ', CODE_WIDTH) << "|" << center(std::to_string(it->second), ' ', FLOW_WIDTH) << "|\n";
     }
@@ -279,17 +391,21 @@ void Menu::printFlowPerCity(std::unordered_map<std::string,int> flowCities, prin
     ofs << oss.str();
     ofs.close();
 
+    formatSpan.end();
+    printQueryStats();
     if (options.showEndMenu)
         endDisplayMenu();
     getInput();
 }
 
 /**
- * @brief Prints in a tabular form the code of the city and the respective flow deficit, as well as the total in the end
+ * @brief Prints in a tabular form, in code order, the code of the city and the respective flow deficit, as well as the
+ * total in the end
  * @param deficitCities Hashmap that contains the flow deficit per city
  * @param options Printing options
  */
 void Menu::printFlowDeficitPerCity(std::unordered_map<std::string,int> deficitCities, printingOptions options) {
+    TraceScope formatSpan("format", "printFlowDeficitPerCity");
     std::ostringstream oss;
 
     if (options.clear)
@@ -309,7 +425,11 @@ void Menu::printFlowDeficitPerCity(std::unordered_map<std::string,int> deficitCi
 
     // CITIES AND FLOWS
     int total = 0;
-    for (auto it = deficitCities.begin(); it != deficitCities.end(); it++) {
+    std::vector<std::pair<std::string,int>> sorted(deficitCities.begin(), deficitCities.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) {
+        return Graph::codeLess(a.first, b.first);
+    });
+    for (auto it = sorted.begin(); it != sorted.end(); it++) {
         total += it->second;
         oss << "|" << center(it->first, ' ', CODE_WIDTH) << "|" << center(std::to_string(it->second), ' ', DEFICIT_WIDTH) << "|\n";
     }
@@ -330,6 +450,8 @@ void Menu::printFlowDeficitPerCity(std::unordered_map<std::string,int> deficitCi
     ofs << oss.str();
     ofs.close();
 
+    formatSpan.end();
+    printQueryStats();
     if (options.showEndMenu)
         endDisplayMenu();
     getInput();
@@ -342,6 +464,7 @@ void Menu::printFlowDeficitPerCity(std::unordered_map<std::string,int> deficitCi
  * @param options Printing options
  */
 void Menu::printCrucialPipes(std::vector<std::pair<Pipe *, flowDiff>> crucialPipes, printingOptions options) {
+    TraceScope formatSpan("format", "printCrucialPipes");
     std::ostringstream oss;
 
     if (options.clear)
@@ -375,6 +498,8 @@ void Menu::printCrucialPipes(std::vector<std::pair<Pipe *, flowDiff>> crucialPip
     ofs << oss.str();
     ofs.close();
 
+    formatSpan.end();
+    printQueryStats();
     if (options.showEndMenu)
         endDisplayMenu();
     getInput();
@@ -387,6 +512,7 @@ void Menu::printCrucialPipes(std::vector<std::pair<Pipe *, flowDiff>> crucialPip
  * @param options Printing options
  */
 void Menu::printCitiesAffected(std::vector<std::pair<std::string, flowDiff>> citiesAffected, printingOptions options) {
+    TraceScope formatSpan("format", "printCitiesAffected");
     std::ostringstream oss;
 
     if (options.clear)
@@ -425,12 +551,64 @@ void Menu::printCitiesAffected(std::vector<std::pair<std::string, flowDiff>> cit
     ofs << oss.str();
     ofs.close();
 
+    formatSpan.end();
+    printQueryStats();
     if (options.showEndMenu)
         endDisplayMenu();
     getInput();
 }
 
 
+/**
+ * @brief Prints in a tabular form every failure, the code of each city it affects, and the respective previous and new
+ * flow, as well as the flow difference
+ * @param contingencies Failures and the cities they affect
+ * @param options Printing options
+ */
+void Menu::printContingencies(std::vector<contingency> contingencies, printingOptions options) {
+    TraceScope formatSpan("format", "printContingencies");
+    std::ostringstream oss;
+
+    if (options.clear)
+        system("clear");
+    if (options.printMessage)
+        oss << options.message;
+
+    // HEADERS
+    oss << "|" << fill('-', DEFICIT_WIDTH) << "|" << fill('-', CODE_WIDTH) << "|" << fill('-', FLOW_WIDTH) << "|" << fill('-', FLOW_WIDTH) << "|" << fill('-', DEFICIT_WIDTH) << "|\n";
+    oss << "|" << center("Failure", ' ', DEFICIT_WIDTH) << "|" << center("Code", ' ', CODE_WIDTH) << "|" << center("Old Flow", ' ', FLOW_WIDTH) << "|" << center("New Flow", ' ', FLOW_WIDTH) << "|" << center("Flow Difference", ' ', DEFICIT_WIDTH) << "|\n";
+    oss << "|" << fill('-', DEFICIT_WIDTH) << "|" << fill('-', CODE_WIDTH) << "|" << fill('-', FLOW_WIDTH) << "|" << fill('-', FLOW_WIDTH) << "|" << fill('-', DEFICIT_WIDTH) << "|\n";
+
+    // FAILURES, CITIES AND FLOWS
+    for (const contingency &c : contingencies) {
+        std::string failure = c.servicePoint != nullptr ? c.servicePoint->getCode() : c.pipe->getOrig()->getCode() + " - " + c.pipe->getDest()->getCode();
+        for (const std::pair<std::string, flowDiff> &cityDiff : c.citiesAffected) {
+            int oldFlow = cityDiff.second.oldFlow;
+            int newFlow = cityDiff.second.newFlow;
+            oss << "|" << center(failure, ' ', DEFICIT_WIDTH) << "|" << center(cityDiff.first, ' ', CODE_WIDTH) << "|" << center(std::to_string(oldFlow), ' ', FLOW_WIDTH) << "|" << center(std::to_string(newFlow), ' ', FLOW_WIDTH) << "|" << center(std::to_string(newFlow - oldFlow), ' ', DEFICIT_WIDTH) << "|\n";
+        }
+    }
+
+    // CLOSING TABLE
+    oss << "|" << fill('-', DEFICIT_WIDTH) << "|" << fill('-', CODE_WIDTH) << "|" << fill('-', FLOW_WIDTH) << "|" << fill('-', FLOW_WIDTH) << "|" << fill('-', DEFICIT_WIDTH) << "|\n";
+
+    oss << "\n\n";
+
+    std::cout << oss.str();
+
+    // Output to file
+    std::ofstream ofs;
+    ofs.open(outputFile, std::ios_base::app);
+    ofs << oss.str();
+    ofs.close();
+
+    formatSpan.end();
+    printQueryStats();
+    if (options.showEndMenu)
+        endDisplayMenu();
+    getInput();
+}
+
 /**
  * @brief Returns a string with c repeated width times.
  * @param c Character to fill with
@@ -41,11 +41,28 @@ private:
     std::string datasets[2] = {"Small", "Large"};
     int curDataset = 0;
 
+    /**
+     * @brief Contains the names of the max flow algorithms available.
+     */
+    std::string algorithms[3] = {"Edmonds-Karp", "Dinic", "Push-Relabel"};
+
     /**
      * @brief Path of the output file
      */
     std::string outputFile = "../data/output.txt";
 
+    /**
+     * @brief Print the memory report after every query
+     */
+    bool memoryReport = false;
+
+    /**
+     * @brief Snapshot to load, snapshot to save and results file of the dataset loaded at start, empty if unused.
+     * The other datasets use the same paths followed by their number
+     */
+    std::string snapshotLoadPath, snapshotSavePath, resultsPath;
+    int startDataset = -1;
+
     // Table column widths
     const static int MENU_WIDTH = 86;
     const static int CODE_WIDTH = 10;
@@ -55,6 +72,9 @@ private:
 public:
     Menu(Graph *g);
     void run();
+    void usePrecomputedResults(const std::string &path);
+    void setDatasetFiles(int dataset, const std::string &loadPath, const std::string &savePath, const std::string &results);
+    void setMemoryReport(bool report);
 
 private:
     // Wait for inputs
@@ -64,6 +84,9 @@ private:
     // Print menus
     void printMainMenu();
     void endDisplayMenu();
+    void printQueryStats();
+    std::string datasetPath(const std::string &path) const;
+    void loadDataset();
     void printBackToMenu();
     void printExit();
 
@@ -85,6 +108,7 @@ private:
     void printFlowDeficitPerCity(std::unordered_map<std::string,int> deficitCities, printingOptions options);
     void printCrucialPipes(std::vector<std::pair<Pipe *, flowDiff>> crucialPipes, printingOptions options);
     void printCitiesAffected(std::vector<std::pair<std::string, flowDiff>> citiesAffected, printingOptions options);
+    void printContingencies(std::vector<contingency> contingencies, printingOptions options);
 };
 
 
@@ -0,0 +1,442 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+#include "NetworkGenerator.h"
+
+/**
+ * @brief Generates a network
+ * @param options sizes, topology and seed
+ * @details Throws a logic_error if there is not a Reservoir, a Station and a City, or too few Pipes to feed them.
+ * Time Complexity O(R+S+C+P), R = number of Reservoirs, S = number of Stations, C = number of Cities,
+ * P = number of Pipes
+ */
+NetworkGenerator::NetworkGenerator(const GeneratorOptions &options) : options(options), rng(options.seed) {
+    if (options.reservoirs < 1 || options.stations < 1 || options.cities < 1) {
+        throw std::logic_error("A network needs at least one Reservoir, one Station and one City");
+    }
+    if (options.pipes < (long) options.stations + options.cities) {
+        throw std::logic_error("A network needs a Pipe for every Station and every City");
+    }
+
+    reservoirs.reserve(options.reservoirs);
+    for (int i = 1; i <= options.reservoirs; i++) {
+        reservoirs.push_back({"Reservoir " + std::to_string(i), "Municipality " + std::to_string(uniform(1, 100)),
+                              "R_" + std::to_string(i), uniform(500, 5000)});
+    }
+    stations.reserve(options.stations);
+    for (int i = 1; i <= options.stations; i++)
+        stations.push_back("PS_" + std::to_string(i));
+    cities.reserve(options.cities);
+    for (int i = 1; i <= options.cities; i++) {
+        int population = uniform(1000, 500000);
+        cities.push_back({"City " + std::to_string(i), "C_" + std::to_string(i), population / 150 + uniform(1, 50),
+                          population});
+    }
+
+    pipes.reserve(options.pipes);
+    switch (options.topology) {
+        case NetworkTopology::TREE:
+            generateTree();
+            break;
+        case NetworkTopology::GRID:
+            generateGrid();
+            break;
+        case NetworkTopology::MIXED:
+            generateMixed();
+            break;
+        default:
+            generateRandom();
+    }
+}
+
+/**
+ * @brief Feeds each Station from a Reservoir or an earlier Station and each City from a Station, then links random
+ * Reservoirs to Stations, Stations to each other and Stations to Cities
+ */
+void NetworkGenerator::generateRandom() {
+    auto anyReservoir = [&]() { return reservoirId(uniform(0, options.reservoirs - 1)); };
+    auto anyStation = [&]() { return stationId(uniform(0, options.stations - 1)); };
+    auto anyCity = [&]() { return cityId(uniform(0, options.cities - 1)); };
+
+    for (int i = 0; i < options.stations; i++) {
+        bool fromReservoir = i == 0 || uniform(0, 9) < 3;
+        uint32_t from = fromReservoir ? anyReservoir() : stationId(uniform(0, i - 1));
+        pipes.push_back({from, stationId(i), uniform(100, 1000), false});
+    }
+    for (int i = 0; i < options.cities; i++)
+        pipes.push_back({anyStation(), cityId(i), uniform(20, 400), false});
+
+    while ((long) pipes.size() < options.pipes) {
+        int kind = uniform(0, 9);
+        if (kind < 2) {
+            pipes.push_back({anyReservoir(), anyStation(), uniform(100, 1000), false});
+        } else if (kind < 7) {
+            uint32_t a = anyStation();
+            uint32_t b = anyStation();
+            if (a == b)
+                continue;
+            pipes.push_back({a, b, uniform(20, 800), bidirectional()});
+        } else {
+            pipes.push_back({anyStation(), anyCity(), uniform(20, 400), false});
+        }
+    }
+}
+
+/**
+ * @brief Makes every Station part of a distribution trunk, with the Cities at the far end of the branches, then adds
+ * redundant links between nearby branches, second feeds of Cities and more Reservoir feeds
+ */
+void NetworkGenerator::generateTree() {
+    int s = options.stations;
+    std::vector<int> depth;
+    addTrunks(s, depth);
+    for (int i = 0; i < options.cities; i++)
+        pipes.push_back({stationId(uniform(s / 2, s - 1)), cityId(i), uniform(20, 400), false});
+
+    int roots = std::min(options.reservoirs, s);
+    while ((long) pipes.size() < options.pipes) {
+        int kind = uniform(0, 9);
+        if (kind < 6) {
+            addTrunkLink(s);
+        } else if (kind < 9) {
+            pipes.push_back({stationId(uniform(s / 2, s - 1)), cityId(uniform(0, options.cities - 1)),
+                             uniform(20, 400), false});
+        } else {
+            pipes.push_back({reservoirId(uniform(0, options.reservoirs - 1)),
+                             stationId(uniform(0, std::min(s, 4 * roots) - 1)), uniform(1000, 5000), false});
+        }
+    }
+}
+
+/**
+ * @brief Lays the Stations out as one grid fed from a corner, with the Cities anywhere on it, then adds Reservoirs on
+ * its border, the missing streets in a scrambled order and diagonal links
+ */
+void NetworkGenerator::generateGrid() {
+    int s = options.stations;
+    addDistrict(0, s, 0);
+    for (int i = 0; i < options.cities; i++)
+        pipes.push_back({stationId(uniform(0, s - 1)), cityId(i), uniform(20, 400), false});
+
+    int width = std::max(1, (int) std::sqrt((double) s));
+    for (int i = 1; i < options.reservoirs && (long) pipes.size() < options.pipes; i++) {
+        int cell = uniform(0, 1) == 0 ? uniform(0, std::min(width, s) - 1) : uniform(0, (s - 1) / width) * width;
+        pipes.push_back({reservoirId(i), stationId(cell), uniform(3000, 6000), false});
+    }
+
+    // A step coprime with the number of Stations visits every cell once, spreading the streets over the grid
+    long step = 1000003;
+    while (std::gcd(step, (long) s) != 1)
+        step += 2;
+    long visited = 0;
+    while ((long) pipes.size() < options.pipes) {
+        int kind = uniform(0, 9);
+        if (kind < 8 && visited < s) {
+            int cell = (int) (visited++ * step % s);
+            if (cell >= width && cell % width != 0)
+                pipes.push_back({stationId(cell - width), stationId(cell), uniform(100, 800), bidirectional()});
+            continue;
+        }
+        int cell = uniform(0, s - 1);
+        if (kind != 8 && cell + width + 1 < s && cell % width != width - 1)
+            pipes.push_back({stationId(cell), stationId(cell + width + 1), uniform(100, 800), bidirectional()});
+        else
+            pipes.push_back({stationId(cell), cityId(uniform(0, options.cities - 1)), uniform(20, 400), false});
+    }
+}
+
+/**
+ * @brief Makes a quarter of the Stations distribution trunks and splits the others into grid districts fed by the
+ * trunks, with most Cities in the districts, then adds district streets, redundant trunk links, second feeds of
+ * Cities and more Reservoir feeds
+ */
+void NetworkGenerator::generateMixed() {
+    int s = options.stations;
+    int trunks = std::max(1, s / 4);
+    int rest = s - trunks;
+    std::vector<int> depth;
+    addTrunks(trunks, depth);
+
+    int districtCount = rest > 0 ? std::max(1, rest / 2500) : 0;
+    std::vector<int> districtStart;
+    for (int d = 0; d < districtCount; d++) {
+        int first = trunks + (int) ((long) rest * d / districtCount);
+        int last = trunks + (int) ((long) rest * (d + 1) / districtCount);
+        districtStart.push_back(first);
+        addDistrict(first, last - first, trunks);
+    }
+    districtStart.push_back(s);
+
+    auto anyCityFeeder = [&]() {
+        if (rest > 0 && uniform(0, 4) < 4)
+            return stationId(trunks + uniform(0, rest - 1));
+        return stationId(uniform(trunks / 2, trunks - 1));
+    };
+    for (int i = 0; i < options.cities; i++)
+        pipes.push_back({anyCityFeeder(), cityId(i), uniform(20, 400), false});
+
+    int roots = std::min(options.reservoirs, trunks);
+    while ((long) pipes.size() < options.pipes) {
+        int kind = uniform(0, 9);
+        if (kind < 5 && rest > 0) {
+            int cell = trunks + uniform(0, rest - 1);
+            int d = (int) (std::upper_bound(districtStart.begin(), districtStart.end(), cell) - districtStart.begin()) - 1;
+            int first = districtStart[d];
+            int width = std::max(1, (int) std::sqrt((double) (districtStart[d + 1] - first)));
+            if (cell - first >= width && (cell - first) % width != 0) {
+                pipes.push_back({stationId(cell - width), stationId(cell), uniform(100, 800), bidirectional()});
+                continue;
+            }
+            pipes.push_back({stationId(cell), cityId(uniform(0, options.cities - 1)), uniform(20, 400), false});
+        } else if (kind < 7) {
+            addTrunkLink(trunks);
+        } else if (kind < 9) {
+            pipes.push_back({anyCityFeeder(), cityId(uniform(0, options.cities - 1)), uniform(20, 400), false});
+        } else {
+            pipes.push_back({reservoirId(uniform(0, options.reservoirs - 1)),
+                             stationId(uniform(0, std::min(trunks, 4 * roots) - 1)), uniform(1000, 5000), false});
+        }
+    }
+}
+
+/**
+ * @brief Feeds the first Stations as trunks that branch out in three: each of the first ones from a Reservoir, and
+ * each of the others from a Station of the level above, with capacities that shrink further down
+ * @param count number of Stations in the trunks, from the first one
+ * @param depth receives the level of each Station, 0 for those fed by a Reservoir
+ */
+void NetworkGenerator::addTrunks(int count, std::vector<int> &depth) {
+    int roots = std::min(options.reservoirs, count);
+    depth.assign(count, 0);
+    for (int i = 0; i < count; i++) {
+        if (i < roots) {
+            pipes.push_back({reservoirId(i), stationId(i), uniform(3000, 6000), false});
+            continue;
+        }
+        int parent = (i - roots) / 3;
+        depth[i] = depth[parent] + 1;
+        int base = std::max(100, 6000 / (depth[i] + 1));
+        pipes.push_back({stationId(parent), stationId(i), uniform(base / 2, base), false});
+    }
+}
+
+/**
+ * @brief Lays Stations out as a grid district fed at its corner, with each Station fed from its left neighbour or,
+ * at the start of a row, from the one above. Those are the only streets, the others are added later
+ * @param first first Station of the district
+ * @param count number of Stations of the district
+ * @param trunks number of trunk Stations to feed the district from, 0 to feed it from the first Reservoir
+ */
+void NetworkGenerator::addDistrict(int first, int count, int trunks) {
+    int width = std::max(1, (int) std::sqrt((double) count));
+    for (int k = 0; k < count; k++) {
+        int i = first + k;
+        if (k == 0) {
+            if (trunks > 0)
+                pipes.push_back({stationId(uniform(trunks / 2, trunks - 1)), stationId(i), uniform(1000, 3000), false});
+            else
+                pipes.push_back({reservoirId(0), stationId(i), uniform(3000, 6000), false});
+        } else if (k % width != 0) {
+            pipes.push_back({stationId(i - 1), stationId(i), uniform(100, 800), bidirectional()});
+        } else {
+            pipes.push_back({stationId(i - width), stationId(i), uniform(100, 800), bidirectional()});
+        }
+    }
+}
+
+/**
+ * @brief Links a trunk Station to another one a few positions away, which is often on a nearby branch. With a single
+ * trunk Station, feeds a City from it instead
+ * @param trunks number of trunk Stations
+ */
+void NetworkGenerator::addTrunkLink(int trunks) {
+    int a = uniform(0, trunks - 1);
+    int b = (a + uniform(1, 50)) % trunks;
+    if (a == b)
+        pipes.push_back({stationId(a), cityId(uniform(0, options.cities - 1)), uniform(20, 400), false});
+    else
+        pipes.push_back({stationId(a), stationId(b), uniform(50, 500), bidirectional()});
+}
+
+/**
+ * @brief Adds the generated network to a Graph, as reading the dataset files would
+ * @param g
+ * @details Time Complexity O(R+S+C+P), R = number of Reservoirs, S = number of Stations, C = number of Cities,
+ * P = number of Pipes
+ */
+void NetworkGenerator::build(Graph *g) const {
+    g->reserveServicePoints(reservoirs.size() + stations.size() + cities.size());
+    for (size_t i = 0; i < reservoirs.size(); i++) {
+        const ReservoirRow &row = reservoirs[i];
+        g->addReservoir(new Reservoir(row.name, row.municipality, std::to_string(i + 1), row.code, row.maxDelivery));
+    }
+    for (size_t i = 0; i < stations.size(); i++)
+        g->addStation(new Station(std::to_string(i + 1), stations[i]));
+    for (size_t i = 0; i < cities.size(); i++) {
+        const CityRow &row = cities[i];
+        g->addCity(new City(row.name, std::to_string(i + 1), row.code, row.demand, row.population));
+    }
+    std::vector<uint32_t> symbols(reservoirs.size() + stations.size() + cities.size());
+    for (size_t id = 0; id < symbols.size(); id++)
+        symbols[id] = g->getSymbol(getCode((uint32_t) id));
+    g->reservePipes(pipes.size() * 2);
+    for (const PipeRow &row : pipes) {
+        if (row.bidirectional)
+            g->addBidirectionalPipe(symbols[row.servicePointA], symbols[row.servicePointB], row.capacity);
+        else
+            g->addPipe(symbols[row.servicePointA], symbols[row.servicePointB], row.capacity);
+    }
+}
+
+/**
+ * @brief Writes a CSV file with a byte order mark and CRLF line endings, as the large dataset has
+ * @param path
+ * @param header
+ * @param count number of rows
+ * @param row appends the fields of a row
+ * @return false if the file could not be written
+ */
+static bool writeRows(const std::string &path, const std::string &header, size_t count,
+                      const std::function<void(size_t, std::string &)> &row) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+        return false;
+    std::string buffer = "\xEF\xBB\xBF" + header + "\r\n";
+    for (size_t i = 0; i < count; i++) {
+        row(i, buffer);
+        buffer += "\r\n";
+        if (buffer.size() >= (1 << 20)) {
+            out.write(buffer.data(), (std::streamsize) buffer.size());
+            buffer.clear();
+        }
+    }
+    out.write(buffer.data(), (std::streamsize) buffer.size());
+    return (bool) out;
+}
+
+/**
+ * @brief Writes the network as the files of the large dataset (Reservoir.csv, Stations.csv, Cities.csv and
+ * Pipes.csv), which Auxiliar reads back into the same Graph that build gives
+ * @param directory existing directory the files are written to
+ * @return false if a file could not be written
+ * @details Time Complexity O(R+S+C+P), R = number of Reservoirs, S = number of Stations, C = number of Cities,
+ * P = number of Pipes
+ */
+bool NetworkGenerator::writeCsv(const std::string &directory) const {
+    std::string prefix = directory.empty() ? "" : directory + "/";
+    return writeRows(prefix + "Reservoir.csv", "Reservoir,Municipality,Id,Code,Maximum Delivery (m3/sec)",
+                     reservoirs.size(), [&](size_t i, std::string &out) {
+                const ReservoirRow &row = reservoirs[i];
+                out += row.name + ',' + row.municipality + ',' + std::to_string(i + 1) + ',' + row.code + ','
+                        + std::to_string(row.maxDelivery);
+            })
+            && writeRows(prefix + "Stations.csv", "Id,Code", stations.size(), [&](size_t i, std::string &out) {
+                out += std::to_string(i + 1) + ',' + stations[i];
+            })
+            && writeRows(prefix + "Cities.csv", "City,Id,Code,Demand,Population", cities.size(),
+                         [&](size_t i, std::string &out) {
+                const CityRow &row = cities[i];
+                out += row.name + ',' + std::to_string(i + 1) + ',' + row.code + ',' + std::to_string(row.demand)
+                        + ".00," + std::to_string(row.population);
+            })
+            && writeRows(prefix + "Pipes.csv", "Service_Point_A,Service_Point_B,Capacity,Direction", pipes.size(),
+                         [&](size_t i, std::string &out) {
+                const PipeRow &row = pipes[i];
+                out += getCode(row.servicePointA) + ',' + getCode(row.servicePointB) + ','
+                        + std::to_string(row.capacity) + (row.bidirectional ? ",0" : ",1");
+            });
+}
+
+/**
+ * @brief Gets the generated Reservoirs, numbered from 1 in order
+ * @return reservoirs
+ */
+const std::vector<NetworkGenerator::ReservoirRow> & NetworkGenerator::getReservoirs() const {
+    return reservoirs;
+}
+
+/**
+ * @brief Gets the codes of the generated Stations, numbered from 1 in order
+ * @return stations
+ */
+const std::vector<std::string> & NetworkGenerator::getStations() const {
+    return stations;
+}
+
+/**
+ * @brief Gets the generated Cities, numbered from 1 in order
+ * @return cities
+ */
+const std::vector<NetworkGenerator::CityRow> & NetworkGenerator::getCities() const {
+    return cities;
+}
+
+/**
+ * @brief Gets the generated Pipe rows
+ * @return pipes
+ */
+const std::vector<NetworkGenerator::PipeRow> & NetworkGenerator::getPipes() const {
+    return pipes;
+}
+
+/**
+ * @brief Gets the code of a ServicePoint of the rows
+ * @param servicePoint id, Reservoirs first, then Stations and then Cities
+ * @return code
+ */
+const std::string & NetworkGenerator::getCode(uint32_t servicePoint) const {
+    if (servicePoint < reservoirs.size())
+        return reservoirs[servicePoint].code;
+    servicePoint -= (uint32_t) reservoirs.size();
+    if (servicePoint < stations.size())
+        return stations[servicePoint];
+    return cities[servicePoint - stations.size()].code;
+}
+
+/**
+ * @brief Gets the id of the i-th Reservoir
+ * @param i from 0
+ * @return id
+ */
+uint32_t NetworkGenerator::reservoirId(int i) const {
+    return (uint32_t) i;
+}
+
+/**
+ * @brief Gets the id of the i-th Station
+ * @param i from 0
+ * @return id
+ */
+uint32_t NetworkGenerator::stationId(int i) const {
+    return (uint32_t) (options.reservoirs + i);
+}
+
+/**
+ * @brief Gets the id of the i-th City
+ * @param i from 0
+ * @return id
+ */
+uint32_t NetworkGenerator::cityId(int i) const {
+    return (uint32_t) (options.reservoirs + options.stations + i);
+}
+
+/**
+ * @brief Draws whether a Station to Station row is bidirectional
+ * @return bidirectional
+ */
+bool NetworkGenerator::bidirectional() {
+    return uniform(0, 999) < (int) (options.bidirectionalShare * 1000);
+}
+
+/**
+ * @brief Draws an integer, the same sequence for the same seed on every platform
+ * @param low
+ * @param high
+ * @return integer in [low, high]
+ */
+int NetworkGenerator::uniform(int low, int high) {
+    return low + (int) (rng() % (uint32_t) (high - low + 1));
+}
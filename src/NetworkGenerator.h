@@ -0,0 +1,99 @@
+#ifndef PROJECT1_NETWORKGENERATOR_H
+#define PROJECT1_NETWORKGENERATOR_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include "Graph.h"
+
+/**
+ * @brief Shape of a generated network
+ */
+enum class NetworkTopology {
+    RANDOM, // Pipes between random ServicePoints
+    TREE, // distribution trunks that branch out from the Reservoirs, with a few redundant links
+    GRID, // meshed urban grid of Stations, with Reservoirs on its border
+    MIXED // trunks that feed several grid districts
+};
+
+/**
+ * @brief Sizes, shape and seed of a generated network
+ */
+struct GeneratorOptions {
+    int reservoirs = 50;
+    int stations = 1000;
+    int cities = 200;
+    long pipes = 5000; // Pipe rows, a bidirectional row gives two Pipes
+    double bidirectionalShare = 0.2; // share of the Station to Station rows that are bidirectional, except the feeding
+                                     // rows of the random topology
+    NetworkTopology topology = NetworkTopology::RANDOM;
+    uint32_t seed = 1;
+};
+
+/**
+ * @brief Generates synthetic networks with the schema of the datasets, the same for the same options
+ * @details Every Station is fed by a Reservoir or by another Station and every City by a Station, so that water can
+ * reach every ServicePoint. The remaining rows depend on the topology: random links, redundant links between nearby
+ * branches of a trunk, or the missing streets of a grid, along with more Reservoir and City feeds. Capacities, demands
+ * and deliveries are drawn so that part of the demand cannot be met.
+ *
+ * The rows refer to ServicePoints by id: the Reservoirs first, then the Stations and then the Cities, each numbered
+ * from 0 in order.
+ */
+class NetworkGenerator {
+public:
+    struct ReservoirRow {
+        std::string name;
+        std::string municipality;
+        std::string code;
+        int maxDelivery;
+    };
+    struct CityRow {
+        std::string name;
+        std::string code;
+        int demand;
+        int population;
+    };
+    struct PipeRow {
+        uint32_t servicePointA;
+        uint32_t servicePointB;
+        int capacity;
+        bool bidirectional;
+    };
+
+    explicit NetworkGenerator(const GeneratorOptions &options);
+
+    void build(Graph *g) const;
+    bool writeCsv(const std::string &directory) const;
+
+    const std::vector<ReservoirRow> & getReservoirs() const;
+    const std::vector<std::string> & getStations() const;
+    const std::vector<CityRow> & getCities() const;
+    const std::vector<PipeRow> & getPipes() const;
+    const std::string & getCode(uint32_t servicePoint) const;
+
+private:
+    int uniform(int low, int high);
+    bool bidirectional();
+    uint32_t reservoirId(int i) const;
+    uint32_t stationId(int i) const;
+    uint32_t cityId(int i) const;
+
+    void generateRandom();
+    void generateTree();
+    void generateGrid();
+    void generateMixed();
+    void addTrunks(int count, std::vector<int> &depth);
+    void addDistrict(int first, int count, int trunks);
+    void addTrunkLink(int trunks);
+
+    GeneratorOptions options;
+    std::mt19937 rng;
+    std::vector<ReservoirRow> reservoirs;
+    std::vector<std::string> stations; // codes
+    std::vector<CityRow> cities;
+    std::vector<PipeRow> pipes;
+};
+
+#endif //PROJECT1_NETWORKGENERATOR_H
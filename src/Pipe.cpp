@@ -6,7 +6,7 @@
  * @param dest
  * @param capacity
  */
-Pipe::Pipe(ServicePoint *orig, ServicePoint *dest, int capacity): orig(orig), dest(dest), capacity(capacity), capacityCap(capacity) {}
+Pipe::Pipe(ServicePoint *orig, ServicePoint *dest, int capacity): orig(orig), dest(dest), capacity(capacity) {}
 
 /**
  * @details Gets ServicePoint destination
@@ -17,99 +17,105 @@ ServicePoint * Pipe::getDest()  {
 }
 
 /**
- * @brief Gets Pipe capacity
- * @return capacity
+ * @brief Gets the dense index of the Pipe in its Graph
+ * @return index
  */
-double Pipe::getCapacity() const {
-    return this->capacity;
+int Pipe::getIndex() const {
+    return index;
 }
 
 /**
- * @brief Gets origin Pipe
- * @return orig
+ * @brief Sets the dense index of the Pipe in its Graph
+ * @param index
  */
-ServicePoint * Pipe::getOrig()  {
-    return this->orig;
+void Pipe::setIndex(int index) {
+    this->index = index;
 }
 
 /**
- * @brief Gets the reversed Pipe
- * @return reverse
+ * @brief Gets the position of the Pipe in the outgoing Pipes of its origin
+ * @return adjPosition
  */
-Pipe *Pipe::getReverse() const {
-    return this->reverse;
+int Pipe::getAdjPosition() const {
+    return adjPosition;
 }
 
 /**
- * @brief Checks if the pipe is visited
- * @return visited
+ * @brief Sets the position of the Pipe in the outgoing Pipes of its origin
+ * @param position
  */
-bool Pipe::isVisited() const {
-    return this->visited;
+void Pipe::setAdjPosition(int position) {
+    this->adjPosition = position;
 }
 
 /**
- * @brief Gets the flow of a Pipe
- * @return flow
+ * @brief Gets the position of the Pipe in the incoming Pipes of its destination
+ * @return incomingPosition
  */
-double Pipe::getFlow() const {
-    return flow;
+int Pipe::getIncomingPosition() const {
+    return incomingPosition;
 }
 
 /**
- * @brief Returns the pressure of pipe (flow/capacity)
- * @return pressure
+ * @brief Sets the position of the Pipe in the incoming Pipes of its destination
+ * @param position
  */
-float Pipe::getPressure() const {
-    return this->flow/this->capacity;
+void Pipe::setIncomingPosition(int position) {
+    this->incomingPosition = position;
 }
 
 /**
- * @brief Sets the reverse Pipe
- * @param reverse
+ * @brief Gets Pipe capacity
+ * @return capacity
  */
-void Pipe::setReverse(Pipe *reverse) {
-    this->reverse = reverse;
+double Pipe::getCapacity() const {
+    return this->capacity;
 }
 
 /**
- * @brief Sets the flow of Pipe
- * @param flow
+ * @brief Sets Pipe capacity, called through Graph::setPipeCapacity
+ * @param capacity
  */
-void Pipe::setFlow(double flow) {
-    this->flow = flow;
+void Pipe::setCapacity(double capacity) {
+    this->capacity = capacity;
 }
 
 /**
- * @brief Sets the Pipe to operational or not
- * @param b
+ * @brief Gets origin Pipe
+ * @return orig
  */
-void Pipe::setOperational(bool b) {
-    operational=b;
+ServicePoint * Pipe::getOrig()  {
+    return this->orig;
 }
 
 /**
- * @brief Sets the Pipe to visited or not
- * @param visited
+ * @brief Gets the reversed Pipe
+ * @return reverse
  */
-void Pipe::setVisited(bool visited) {
-    this->visited = visited;
+Pipe *Pipe::getReverse() const {
+    return this->reverse;
 }
 
 /**
- * @brief Checks if the Pipe is visited or not
- * @return operational
+ * @brief Sets the reverse Pipe
+ * @param reverse
  */
-bool Pipe::isOperational() const {
-    return operational;
+void Pipe::setReverse(Pipe *reverse) {
+    this->reverse = reverse;
 }
 
-
-double Pipe::getCapacityCap() const {
-    return capacityCap;
+/**
+ * @brief Sets the Pipe to operational or not, called through Graph::setOperational
+ * @param b
+ */
+void Pipe::setOperational(bool b) {
+    operational=b;
 }
 
-
-void Pipe::setCapacityCap(double cap) {
-    capacityCap = cap;
+/**
+ * @brief Checks if the Pipe is visited or not
+ * @return operational
+ */
+bool Pipe::isOperational() const {
+    return operational;
 }
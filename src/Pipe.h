@@ -14,35 +14,36 @@ public:
 
     ServicePoint * getOrig() ;
     ServicePoint * getDest() ;
+    int getIndex() const;
+    void setIndex(int index);
+    int getAdjPosition() const;
+    void setAdjPosition(int position);
+    int getIncomingPosition() const;
+    void setIncomingPosition(int position);
     double getCapacity() const;
     Pipe * getReverse() const;
-    double getFlow() const;
-    float getPressure() const;
 
     bool isOperational() const;
-    bool isVisited() const;
 
     void setSelected(bool selected);
     void setReverse(Pipe *reverse);
-    void setFlow(double flow);
+private:
+    // Only the Graph changes these, so that every change bumps its version
+    friend class Graph;
     void setOperational(bool b);
-    void setVisited(bool visited);
-
-    double getCapacityCap() const;
-    void setCapacityCap(double cap);
+    void setCapacity(double capacity);
 protected:
     ServicePoint *orig;
     ServicePoint * dest; // destination ServicePoint
+    int index = -1; // dense index given by the Graph
+    int adjPosition = -1; // position in the outgoing Pipes of orig
+    int incomingPosition = -1; // position in the incoming Pipes of dest
 
     double capacity; // Pipe weight, can also be used for capacity
-    double flow;
 
     bool operational=true;
-    bool visited = false;
 
     Pipe *reverse = nullptr;
-
-    double capacityCap;
 };
 
 
@@ -50,3 +50,16 @@ std::string Reservoir::getCode() const {
 int Reservoir::getMaxDelivery() {
     return this->maxDelivery;
 }
+
+/**
+ * @brief Adds the bytes of the Reservoir, its Pipe lists and its strings to a report
+ * @param report
+ */
+void Reservoir::addMemoryUsage(MemoryReport &report) const {
+    ServicePoint::addMemoryUsage(report);
+    report.nodes += sizeof(Reservoir);
+    report.strings += MemoryReport::stringBytes(name);
+    report.strings += MemoryReport::stringBytes(municipality);
+    report.strings += MemoryReport::stringBytes(id);
+    report.strings += MemoryReport::stringBytes(code);
+}
@@ -17,6 +17,8 @@ public:
     std::string getCode() const;
     int getMaxDelivery();
 
+    void addMemoryUsage(MemoryReport &report) const override;
+
 private:
     std::string name;
     std::string municipality;
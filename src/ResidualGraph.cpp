@@ -0,0 +1,256 @@
+#include "ResidualGraph.h"
+#include "TraceRecorder.h"
+
+/**
+ * @brief ResidualGraph Constructor, builds the snapshot of a Graph
+ * @param g
+ */
+ResidualGraph::ResidualGraph(const Graph *g) {
+    build(g);
+}
+
+/**
+ * @brief Rebuilds the snapshot from the current Graph. Pipes that are not operational, or with an end that is not
+ * operational, are left out
+ * @param g
+ * @details Time Complexity O(S+P), S = number of ServicePoints, P = number of Pipes
+ */
+void ResidualGraph::build(const Graph *g) {
+    TRACE_SCOPE("setup", "build residual graph");
+    version = g->getVersion();
+    superSource = g->getServicePointIndexBound();
+    superSink = superSource + 1;
+    int servicePointBound = superSink + 1;
+    Span<ServicePoint *> servicePointSet = g->getServicePointSet();
+
+    auto inSnapshot = [](Pipe *e) {
+        return e->isOperational() && e->getOrig()->isOperational() && e->getDest()->isOperational();
+    };
+
+    // Give a Pipe index to the super source and super sink Pipes
+    int pipeBound = g->getPipeIndexBound();
+    std::vector<int> sourcePipe(superSource, -1);
+    std::vector<int> sinkPipe(superSource, -1);
+    std::vector<double> superCapacity;
+    {
+        TRACE_SCOPE("setup", "super nodes");
+        for (ServicePoint *v : g->getReservoirSet()) {
+            if (!v->isOperational())
+                continue;
+            sourcePipe[v->getIndex()] = pipeBound++;
+            superCapacity.push_back(((Reservoir *) v)->getMaxDelivery());
+        }
+        for (ServicePoint *v : g->getCitiesSet()) {
+            if (!v->isOperational())
+                continue;
+            sinkPipe[v->getIndex()] = pipeBound++;
+            superCapacity.push_back(((City *) v)->getDemand());
+        }
+    }
+
+    // Count the arcs of every ServicePoint
+    servicePoints.clear();
+    offsets.assign(servicePointBound + 1, 0);
+    for (ServicePoint *v : servicePointSet) {
+        int i = v->getIndex();
+        servicePoints.push_back(i);
+        for (Pipe *e : v->getAdj()) offsets[i + 1] += inSnapshot(e);
+        for (Pipe *e : v->getIncoming()) offsets[i + 1] += inSnapshot(e);
+        if (sourcePipe[i] != -1) {
+            offsets[i + 1]++;
+            offsets[superSource + 1]++;
+        }
+        if (sinkPipe[i] != -1) {
+            offsets[i + 1]++;
+            offsets[superSink + 1]++;
+        }
+    }
+    servicePoints.push_back(superSource);
+    servicePoints.push_back(superSink);
+    for (int v = 0; v < servicePointBound; v++) {
+        offsets[v + 1] += offsets[v];
+    }
+
+    // Lay out the arcs, forward ones first
+    arcs.resize(offsets[servicePointBound]);
+    forwardArc.assign(pipeBound, -1);
+    capacity.assign(pipeBound, 0);
+    std::vector<int> backwardArc(pipeBound, -1);
+    int sourceArc = offsets[superSource];
+    int sinkArc = offsets[superSink];
+    for (ServicePoint *v : servicePointSet) {
+        int i = v->getIndex();
+        int a = offsets[i];
+        for (Pipe *e : v->getAdj()) {
+            if (!inSnapshot(e))
+                continue;
+            arcs[a] = {e->getDest()->getIndex(), e->getIndex(), -1, true};
+            forwardArc[e->getIndex()] = a++;
+            capacity[e->getIndex()] = e->getCapacity();
+        }
+        if (sinkPipe[i] != -1) {
+            arcs[a] = {superSink, sinkPipe[i], -1, true};
+            forwardArc[sinkPipe[i]] = a++;
+        }
+        for (Pipe *e : v->getIncoming()) {
+            if (!inSnapshot(e))
+                continue;
+            arcs[a] = {e->getOrig()->getIndex(), e->getIndex(), -1, false};
+            backwardArc[e->getIndex()] = a++;
+        }
+        if (sourcePipe[i] != -1) {
+            arcs[a] = {superSource, sourcePipe[i], -1, false};
+            backwardArc[sourcePipe[i]] = a++;
+        }
+    }
+    // The super source arcs follow the Reservoir order and the super sink arcs the City order
+    for (ServicePoint *v : g->getReservoirSet()) {
+        int p = sourcePipe[v->getIndex()];
+        if (p != -1) {
+            arcs[sourceArc] = {v->getIndex(), p, -1, true};
+            forwardArc[p] = sourceArc++;
+        }
+    }
+    for (ServicePoint *v : g->getCitiesSet()) {
+        int p = sinkPipe[v->getIndex()];
+        if (p != -1) {
+            arcs[sinkArc] = {v->getIndex(), p, -1, false};
+            backwardArc[p] = sinkArc++;
+        }
+    }
+
+    // Pair the two arcs of every Pipe
+    pipes.clear();
+    for (Pipe *e : g->getPipeSet()) {
+        if (forwardArc[e->getIndex()] != -1)
+            pipes.push_back(e->getIndex());
+    }
+    for (int p = g->getPipeIndexBound(); p < pipeBound; p++) {
+        capacity[p] = superCapacity[p - g->getPipeIndexBound()];
+        pipes.push_back(p);
+    }
+    for (int p : pipes) {
+        arcs[forwardArc[p]].reverse = backwardArc[p];
+        arcs[backwardArc[p]].reverse = forwardArc[p];
+    }
+}
+
+/**
+ * @brief Gets the version of the Graph the snapshot was built from
+ * @return version
+ */
+unsigned long ResidualGraph::getVersion() const {
+    return version;
+}
+
+/**
+ * @brief Gets the upper bound of the ServicePoint indexes, super source and super sink included
+ * @return bound
+ */
+int ResidualGraph::getServicePointCount() const {
+    return (int) offsets.size() - 1;
+}
+
+/**
+ * @brief Gets the upper bound of the Pipe indexes, super source and super sink Pipes included
+ * @return bound
+ */
+int ResidualGraph::getPipeCount() const {
+    return (int) capacity.size();
+}
+
+/**
+ * @brief Gets the index of the super source
+ * @return superSource
+ */
+int ResidualGraph::getSuperSource() const {
+    return superSource;
+}
+
+/**
+ * @brief Gets the index of the super sink
+ * @return superSink
+ */
+int ResidualGraph::getSuperSink() const {
+    return superSink;
+}
+
+/**
+ * @brief Gets the indexes of the ServicePoints, in the order of the Graph, then the super source and super sink
+ * @return servicePoints
+ */
+const std::vector<int> & ResidualGraph::getServicePoints() const {
+    return servicePoints;
+}
+
+/**
+ * @brief Gets the indexes of the Pipes in the snapshot, in the order of the Graph, then the super source and super sink Pipes
+ * @return pipes
+ */
+const std::vector<int> & ResidualGraph::getPipes() const {
+    return pipes;
+}
+
+/**
+ * @brief Gets the first arc leaving a ServicePoint
+ * @param v ServicePoint index
+ * @return arc index
+ */
+int ResidualGraph::getArcBegin(int v) const {
+    return offsets[v];
+}
+
+/**
+ * @brief Gets the arc after the last one leaving a ServicePoint
+ * @param v ServicePoint index
+ * @return arc index
+ */
+int ResidualGraph::getArcEnd(int v) const {
+    return offsets[v + 1];
+}
+
+/**
+ * @brief Gets an arc
+ * @param a arc index
+ * @return arc
+ */
+const ResidualArc & ResidualGraph::getArc(int a) const {
+    return arcs[a];
+}
+
+/**
+ * @brief Gets the ServicePoint an arc leaves, the head of its paired arc
+ * @param a arc index
+ * @return ServicePoint index
+ */
+int ResidualGraph::getTail(int a) const {
+    return arcs[arcs[a].reverse].head;
+}
+
+/**
+ * @brief Gets the forward arc of a Pipe
+ * @param pipe Pipe index
+ * @return arc index, -1 if the Pipe is not in the snapshot
+ */
+int ResidualGraph::getForwardArc(int pipe) const {
+    return forwardArc[pipe];
+}
+
+/**
+ * @brief Gets the capacity of a Pipe
+ * @param pipe Pipe index
+ * @return capacity
+ */
+double ResidualGraph::getCapacity(int pipe) const {
+    return capacity[pipe];
+}
+
+/**
+ * @brief Gets the bytes of the snapshot
+ * @return bytes
+ */
+std::size_t ResidualGraph::getMemoryUsage() const {
+    return sizeof(ResidualGraph) + MemoryReport::vectorBytes(servicePoints) + MemoryReport::vectorBytes(pipes)
+            + MemoryReport::vectorBytes(offsets) + MemoryReport::vectorBytes(arcs)
+            + MemoryReport::vectorBytes(forwardArc) + MemoryReport::vectorBytes(capacity);
+}
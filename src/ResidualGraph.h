@@ -0,0 +1,62 @@
+#ifndef PROJECT1_RESIDUALGRAPH_H
+#define PROJECT1_RESIDUALGRAPH_H
+
+#include <vector>
+#include "Graph.h"
+
+/**
+ * @brief Residual arc of a ResidualGraph
+ */
+struct ResidualArc {
+    int head; // index of the ServicePoint the arc enters
+    int pipe; // index of the Pipe the arc goes over
+    int reverse; // index of the paired arc, over the same Pipe in the other direction
+    bool forward; // along the Pipe (residual = capacity - flow) or against it (residual = flow)
+};
+
+/**
+ * @brief Immutable compressed sparse row snapshot of the residual network of a Graph, used by the max flow engines
+ * @details Every operational Pipe gives a forward arc, leaving its origin, and a backward arc, leaving its destination.
+ * The arcs of each ServicePoint are contiguous, forward arcs first in the order of its outgoing Pipes and then backward
+ * arcs in the order of its incoming Pipes. ServicePoints and Pipes keep their Graph index, so a FlowState indexes both
+ * the Graph and the snapshot. The snapshot does not follow the Graph, it has to be rebuilt when the Graph version changes.
+ *
+ * The snapshot also holds a super source and a super sink that are not in the Graph, with the indexes right after the
+ * ServicePoint indexes. The super source has an arc to every Reservoir limited by its max delivery and every City has
+ * an arc to the super sink limited by its demand, with Pipe indexes right after the Pipe indexes. These arcs come last
+ * among the arcs of each Reservoir and City
+ */
+class ResidualGraph {
+public:
+    ResidualGraph(const Graph *g);
+
+    void build(const Graph *g);
+    unsigned long getVersion() const;
+    int getServicePointCount() const;
+    int getPipeCount() const;
+    int getSuperSource() const;
+    int getSuperSink() const;
+
+    const std::vector<int> & getServicePoints() const;
+    const std::vector<int> & getPipes() const;
+    int getArcBegin(int v) const;
+    int getArcEnd(int v) const;
+    const ResidualArc & getArc(int a) const;
+    int getTail(int a) const;
+    int getForwardArc(int pipe) const;
+    double getCapacity(int pipe) const;
+    std::size_t getMemoryUsage() const;
+
+private:
+    unsigned long version = 0; // Graph version the snapshot was built from
+    int superSource = 0;
+    int superSink = 0;
+    std::vector<int> servicePoints; // ServicePoint indexes, in Graph order, then the super source and super sink
+    std::vector<int> pipes; // operational Pipe indexes, in Graph order, then the super source and super sink Pipes
+    std::vector<int> offsets; // arcs of ServicePoint v are [offsets[v], offsets[v+1])
+    std::vector<ResidualArc> arcs;
+    std::vector<int> forwardArc; // forward arc of each Pipe, -1 if not in the snapshot
+    std::vector<double> capacity; // capacity of each Pipe
+};
+
+#endif //PROJECT1_RESIDUALGRAPH_H
@@ -0,0 +1,118 @@
+#include "ResultStore.h"
+#include "MappedFile.h"
+#include <cstring>
+#include <fstream>
+
+static const char MAGIC[8] = {'W', 'S', 'R', 'E', 'S', 'U', 'L', 'T'};
+
+/**
+ * @brief Adds bytes to a 64-bit FNV-1a hash
+ * @param hash
+ * @param data
+ * @param size
+ */
+static void fnv1a(uint64_t &hash, const void *data, size_t size) {
+    const auto *bytes = (const unsigned char *) data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+}
+
+/**
+ * @brief Adds a string to a hash, with its length so that consecutive strings cannot run into each other
+ * @param hash
+ * @param s
+ */
+static void fnv1a(uint64_t &hash, const std::string &s) {
+    uint64_t length = s.size();
+    fnv1a(hash, &length, sizeof(length));
+    fnv1a(hash, s.data(), s.size());
+}
+
+/**
+ * @brief Computes the content hash of a network: every ServicePoint and Pipe in Graph order, with the data that the
+ * max flow depends on, and the algorithm, since each one can spread the same max flow differently
+ * @param g
+ * @param algorithm
+ * @return hash
+ * @details Time Complexity O(S+P) S = number of ServicePoints, P = number of Pipes
+ */
+uint64_t ResultStore::hashNetwork(Graph *g, uint32_t algorithm) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    fnv1a(hash, &algorithm, sizeof(algorithm));
+    for (ServicePoint *v : g->getServicePointSet()) {
+        int32_t values[3] = {0, 0, v->isOperational()};
+        if (auto *r = dynamic_cast<Reservoir *>(v)) {
+            values[0] = 1;
+            values[1] = r->getMaxDelivery();
+        } else if (auto *c = dynamic_cast<City *>(v)) {
+            values[0] = 2;
+            values[1] = c->getDemand();
+        }
+        fnv1a(hash, v->getCode());
+        fnv1a(hash, values, sizeof(values));
+    }
+    for (Pipe *e : g->getPipeSet()) {
+        double values[3] = {e->getCapacity(), (double) (e->getReverse() != nullptr), (double) e->isOperational()};
+        fnv1a(hash, e->getOrig()->getCode());
+        fnv1a(hash, e->getDest()->getCode());
+        fnv1a(hash, values, sizeof(values));
+    }
+    return hash;
+}
+
+/**
+ * @brief Writes the baseline flow to a results file
+ * @param path
+ * @param hash content hash of the network
+ * @param r snapshot of the Graph the baseline was computed on
+ * @param baseline
+ * @return false if the file could not be written
+ * @details Time Complexity O(P) P = number of Pipes
+ */
+bool ResultStore::save(const std::string &path, uint64_t hash, const ResidualGraph &r, const FlowState &baseline) {
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.formatVersion = FORMAT_VERSION;
+    header.pipeCount = (uint32_t) r.getPipeCount();
+    header.hash = hash;
+    std::vector<double> flows(header.pipeCount);
+    for (uint32_t p = 0; p < header.pipeCount; p++)
+        flows[p] = baseline.getFlow((int) p);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write((const char *) &header, sizeof(Header));
+    file.write((const char *) flows.data(), (std::streamsize) (flows.size() * sizeof(double)));
+    file.close();
+    return !file.fail();
+}
+
+/**
+ * @brief Reads the baseline flow from a results file, if it was computed for the same network
+ * @param path
+ * @param hash content hash of the network
+ * @param r snapshot of the Graph
+ * @param baseline FlowState that receives the flow, untouched unless the file matches
+ * @return false if the file is missing, damaged, or of another network or format version
+ * @details Time Complexity O(P) P = number of Pipes
+ */
+bool ResultStore::load(const std::string &path, uint64_t hash, const ResidualGraph &r, FlowState &baseline) {
+    MappedFile file(path);
+    std::string_view contents = file.getContents();
+    if (contents.size() < sizeof(Header))
+        return false;
+    Header header{};
+    std::memcpy(&header, contents.data(), sizeof(Header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.formatVersion != FORMAT_VERSION
+        || header.hash != hash || header.pipeCount != (uint32_t) r.getPipeCount()
+        || contents.size() != sizeof(Header) + header.pipeCount * sizeof(double))
+        return false;
+
+    const auto *flows = (const double *) (contents.data() + sizeof(Header));
+    baseline.resize(r);
+    baseline.reset();
+    for (uint32_t p = 0; p < header.pipeCount; p++)
+        baseline.setFlow((int) p, flows[p]);
+    return true;
+}
@@ -0,0 +1,32 @@
+#ifndef PROJECT1_RESULTSTORE_H
+#define PROJECT1_RESULTSTORE_H
+
+#include <cstdint>
+#include <string>
+#include "Graph.h"
+#include "FlowState.h"
+
+/**
+ * @brief Sidecar file keeping the baseline max flow of a network across runs
+ * @details The file holds the flow of every Pipe of the baseline solve, including the super source and super sink
+ * Pipes, and the content hash of the network it was computed for. The flow per City, the deficits and the residual
+ * network of the failure analyses all follow from those flows, so a matching file saves the first full max flow.
+ */
+class ResultStore {
+public:
+    static const uint32_t FORMAT_VERSION = 2; // 2: the baseline flow is spread over the Cities in code order
+
+    static uint64_t hashNetwork(Graph *g, uint32_t algorithm);
+    static bool save(const std::string &path, uint64_t hash, const ResidualGraph &r, const FlowState &baseline);
+    static bool load(const std::string &path, uint64_t hash, const ResidualGraph &r, FlowState &baseline);
+
+private:
+    struct Header {
+        char magic[8];
+        uint32_t formatVersion;
+        uint32_t pipeCount; // Pipes of the ResidualGraph, one flow each
+        uint64_t hash;
+    };
+};
+
+#endif //PROJECT1_RESULTSTORE_H
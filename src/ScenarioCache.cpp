@@ -0,0 +1,220 @@
+#include "ScenarioCache.h"
+
+/**
+ * @brief Constructor of the ScenarioCache
+ * @param capacity maximum number of scenarios kept, 0 disables the cache
+ */
+ScenarioCache::ScenarioCache(std::size_t capacity) : capacity(capacity) {}
+
+/**
+ * @brief Copy constructor of the ScenarioCache, which points the lookup table at the copied entries
+ * @param other
+ */
+ScenarioCache::ScenarioCache(const ScenarioCache &other)
+        : entries(other.entries), capacity(other.capacity), version(other.version), hits(other.hits),
+          misses(other.misses), evictions(other.evictions), invalidations(other.invalidations) {
+    index();
+}
+
+/**
+ * @brief Copy assignment of the ScenarioCache, which points the lookup table at the copied entries
+ * @param other
+ * @return this cache
+ */
+ScenarioCache & ScenarioCache::operator=(const ScenarioCache &other) {
+    if (this == &other)
+        return *this;
+    entries = other.entries;
+    capacity = other.capacity;
+    version = other.version;
+    hits = other.hits;
+    misses = other.misses;
+    evictions = other.evictions;
+    invalidations = other.invalidations;
+    index();
+    return *this;
+}
+
+/**
+ * @brief Gets the element of a failed ServicePoint in a scenario
+ * @param index index of the ServicePoint
+ * @return element
+ */
+uint64_t ScenarioCache::servicePointKey(int index) {
+    return key(SERVICE_POINT_TAG, (uint32_t) index);
+}
+
+/**
+ * @brief Gets the element of a failed Pipe in a scenario
+ * @param index index of the Pipe, the lower one of the pair if it is bidirectional
+ * @return element
+ */
+uint64_t ScenarioCache::pipeKey(int index) {
+    return key(PIPE_TAG, (uint32_t) index);
+}
+
+/**
+ * @brief Packs the kind of an element and its value
+ * @param tag kind of the element
+ * @param value
+ * @return element
+ */
+uint64_t ScenarioCache::key(KeyTag tag, uint32_t value) {
+    return ((uint64_t) tag << 32) | value;
+}
+
+/**
+ * @brief Finds the flow per City of a scenario and marks it as the most recently used
+ * @param version current version of the Graph
+ * @param scenario canonical set of failed elements
+ * @return pointer to the flow per City, nullptr if the scenario is not cached. It is valid until the cache changes
+ * @details Time Complexity O(K) on average, K = size of the scenario, O(N) if the Graph changed, N = number of entries
+ */
+const ScenarioCache::FlowPerCity * ScenarioCache::find(unsigned long version, const Scenario &scenario) {
+    checkVersion(version);
+    auto it = positions.find(scenario);
+    if (it == positions.end()) {
+        misses++;
+        return nullptr;
+    }
+    hits++;
+    entries.splice(entries.begin(), entries, it->second);
+    return &it->second->flowPerCity;
+}
+
+/**
+ * @brief Caches the flow per City of a scenario, evicting the least recently used one if the cache is full
+ * @param version version of the Graph the flow was computed on
+ * @param scenario canonical set of failed elements
+ * @param flowPerCity
+ * @details Time Complexity O(K+C) on average, K = size of the scenario, C = number of Cities
+ */
+void ScenarioCache::insert(unsigned long version, const Scenario &scenario, const FlowPerCity &flowPerCity) {
+    if (capacity == 0)
+        return;
+    checkVersion(version);
+    auto it = positions.find(scenario);
+    if (it != positions.end()) {
+        it->second->flowPerCity = flowPerCity;
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+    evict(capacity - 1);
+    entries.push_front({scenario, flowPerCity});
+    positions[scenario] = entries.begin();
+}
+
+/**
+ * @brief Removes every scenario, keeping the counters
+ * @details Time Complexity O(N), N = number of entries
+ */
+void ScenarioCache::clear() {
+    entries.clear();
+    positions.clear();
+}
+
+/**
+ * @brief Sets the maximum number of scenarios kept, evicting the least recently used ones above it
+ * @param capacity 0 disables the cache
+ */
+void ScenarioCache::setCapacity(std::size_t capacity) {
+    this->capacity = capacity;
+    evict(capacity);
+}
+
+/**
+ * @brief Gets the maximum number of scenarios kept
+ * @return capacity
+ */
+std::size_t ScenarioCache::getCapacity() const {
+    return capacity;
+}
+
+/**
+ * @brief Gets the number of scenarios cached
+ * @return size
+ */
+std::size_t ScenarioCache::size() const {
+    return entries.size();
+}
+
+/**
+ * @brief Gets the number of lookups that found their scenario
+ * @return hits
+ */
+unsigned long ScenarioCache::getHits() const {
+    return hits;
+}
+
+/**
+ * @brief Gets the number of lookups that did not find their scenario
+ * @return misses
+ */
+unsigned long ScenarioCache::getMisses() const {
+    return misses;
+}
+
+/**
+ * @brief Gets the number of scenarios evicted to respect the capacity
+ * @return evictions
+ */
+unsigned long ScenarioCache::getEvictions() const {
+    return evictions;
+}
+
+/**
+ * @brief Gets the number of scenarios dropped because the Graph changed
+ * @return invalidations
+ */
+unsigned long ScenarioCache::getInvalidations() const {
+    return invalidations;
+}
+
+/**
+ * @brief Drops every scenario if they were computed on another version of the Graph
+ * @param version current version of the Graph
+ */
+void ScenarioCache::checkVersion(unsigned long version) {
+    if (version == this->version)
+        return;
+    invalidations += entries.size();
+    clear();
+    this->version = version;
+}
+
+/**
+ * @brief Evicts the least recently used scenarios until at most capacity are left
+ * @param capacity
+ */
+void ScenarioCache::evict(std::size_t capacity) {
+    while (entries.size() > capacity) {
+        positions.erase(entries.back().scenario);
+        entries.pop_back();
+        evictions++;
+    }
+}
+
+/**
+ * @brief Rebuilds the lookup table from the entries
+ * @details Time Complexity O(N*K), N = number of entries, K = size of a scenario
+ */
+void ScenarioCache::index() {
+    positions.clear();
+    for (auto it = entries.begin(); it != entries.end(); ++it)
+        positions[it->scenario] = it;
+}
+
+/**
+ * @brief Hashes a scenario, mixing each of its elements in turn
+ * @param scenario
+ * @return hash
+ */
+std::size_t ScenarioCache::ScenarioHash::operator()(const Scenario &scenario) const {
+    uint64_t hash = 14695981039346656037ULL;
+    for (uint64_t element : scenario) {
+        hash ^= element;
+        hash *= 1099511628211ULL;
+        hash ^= hash >> 32;
+    }
+    return (std::size_t) hash;
+}
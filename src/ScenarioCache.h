@@ -0,0 +1,70 @@
+#ifndef PROJECT1_SCENARIOCACHE_H
+#define PROJECT1_SCENARIOCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Least recently used cache of the flow per City of failure scenarios
+ * @details A scenario is the canonical set of failed elements, sorted and without repeats. The flow per City does not
+ * depend on the solver settings, as Management spreads every max flow over the Cities in the same way, so the
+ * entries are shared by all of them. Every entry belongs to one version of the Graph: a lookup with another version
+ * drops all of them, so no result computed before a change of the network is ever returned.
+ */
+class ScenarioCache {
+public:
+    typedef std::vector<uint64_t> Scenario;
+    typedef std::unordered_map<std::string,int> FlowPerCity;
+
+    explicit ScenarioCache(std::size_t capacity = 256);
+    ScenarioCache(const ScenarioCache &other);
+    ScenarioCache & operator=(const ScenarioCache &other);
+
+    static uint64_t servicePointKey(int index);
+    static uint64_t pipeKey(int index);
+
+    const FlowPerCity * find(unsigned long version, const Scenario &scenario);
+    void insert(unsigned long version, const Scenario &scenario, const FlowPerCity &flowPerCity);
+    void clear();
+
+    void setCapacity(std::size_t capacity);
+    std::size_t getCapacity() const;
+    std::size_t size() const;
+    unsigned long getHits() const;
+    unsigned long getMisses() const;
+    unsigned long getEvictions() const;
+    unsigned long getInvalidations() const;
+
+private:
+    // Kind of an element, kept in its upper 32 bits so that elements of different kinds never collide
+    enum KeyTag : uint64_t { SERVICE_POINT_TAG, PIPE_TAG };
+
+    static uint64_t key(KeyTag tag, uint32_t value);
+
+    struct ScenarioHash {
+        std::size_t operator()(const Scenario &scenario) const;
+    };
+    struct Entry {
+        Scenario scenario;
+        FlowPerCity flowPerCity;
+    };
+
+    void checkVersion(unsigned long version);
+    void evict(std::size_t capacity);
+    void index();
+
+    std::list<Entry> entries; // most recently used first
+    std::unordered_map<Scenario, std::list<Entry>::iterator, ScenarioHash> positions;
+    std::size_t capacity;
+    unsigned long version = 0; // Graph version of the entries
+    unsigned long hits = 0;
+    unsigned long misses = 0;
+    unsigned long evictions = 0;
+    unsigned long invalidations = 0; // entries dropped because the Graph changed
+};
+
+#endif //PROJECT1_SCENARIOCACHE_H
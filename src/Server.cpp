@@ -0,0 +1,222 @@
+#include "Server.h"
+#include "Auxiliar.h"
+#include "Batch.h"
+#include "Snapshot.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+ * @brief Server Constructor, takes ownership of the Graph and computes its baseline flow
+ * @param g
+ * @param resultsPath results file to take the baseline from, or to write it to, empty for none
+ */
+Server::Server(Graph *g, const std::string &resultsPath): network(new Network(g)) {
+    prepare(*network, resultsPath);
+}
+
+/**
+ * @brief Server Destructor, deletes the Graph being served
+ */
+Server::~Server() {
+    delete network->g;
+}
+
+/**
+ * @brief Makes the baseline flow of a network resident, from a results file when there is a matching one
+ * @param network
+ * @param resultsPath results file, empty for none
+ */
+void Server::prepare(Network &network, const std::string &resultsPath) {
+    if (!resultsPath.empty() && (network.m.loadBaseline(resultsPath) || network.m.saveBaseline(resultsPath)))
+        return;
+    network.m.getMaxFlow();
+}
+
+/**
+ * @brief Listens on a Unix domain socket and serves clients until one sends shutdown
+ * @param socketPath path of the socket, replaced if it exists
+ * @return false if the socket could not be created
+ */
+bool Server::run(const std::string &socketPath) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Socket path too long: " << socketPath << "\n";
+        return false;
+    }
+    std::strcpy(address.sun_path, socketPath.c_str());
+    unlink(socketPath.c_str());
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd == -1 || bind(listenFd, (sockaddr *) &address, sizeof(address)) == -1 || listen(listenFd, 64) == -1) {
+        std::cerr << "Could not listen on " << socketPath << ": " << std::strerror(errno) << "\n";
+        if (listenFd != -1)
+            close(listenFd);
+        return false;
+    }
+
+    while (!stopping) {
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd == -1) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            break;
+        }
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        if (stopping) {
+            close(fd);
+            break;
+        }
+        clientFds.push_back(fd);
+        std::thread(&Server::serveClient, this, fd).detach();
+    }
+
+    // Wake the clients still waiting for a request and wait for them to leave
+    std::unique_lock<std::mutex> lock(clientsMutex);
+    for (int fd : clientFds)
+        shutdown(fd, SHUT_RDWR);
+    clientsDone.wait(lock, [this] { return clientFds.empty(); });
+    close(listenFd);
+    unlink(socketPath.c_str());
+    return true;
+}
+
+/**
+ * @brief Stops accepting clients, so that run returns once the connected ones leave
+ */
+void Server::stop() {
+    stopping = true;
+    shutdown(listenFd, SHUT_RDWR);
+}
+
+/**
+ * @brief Answers the requests of one client until it disconnects
+ * @param fd socket of the client
+ */
+void Server::serveClient(int fd) {
+    std::unique_ptr<Management> m; // copy of the shared Management, so queries of other clients do not interfere
+    Graph *g = nullptr;
+    unsigned long seenGeneration = 0;
+    std::string buffer;
+    char chunk[4096];
+    int line = 0;
+    bool open = true;
+
+    while (open && !stopping) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0)
+            break;
+        buffer.append(chunk, (size_t) n);
+        size_t end;
+        while (open && (end = buffer.find('\n')) != std::string::npos) {
+            std::string request = buffer.substr(0, end);
+            buffer.erase(0, end + 1);
+            if (!request.empty() && request.back() == '\r')
+                request.pop_back();
+            line++;
+
+            std::istringstream ss(request);
+            std::string name, arg;
+            std::vector<std::string> args;
+            ss >> name;
+            while (ss >> arg)
+                args.push_back(arg);
+
+            std::ostringstream out;
+            if (name == "shutdown") {
+                stop();
+                open = false;
+            } else if (name == "reload") {
+                try {
+                    reload(args);
+                    std::shared_lock<std::shared_mutex> lock(networkMutex);
+                    out << line << ",reload," << (args.empty() ? "" : args.back()) << ",ok,"
+                        << network->g->getServicePointSet().size() << ',' << network->g->getPipeSet().size() << '\n';
+                } catch (const std::exception &e) {
+                    out << line << ",error," << request << ',' << e.what() << ",,\n";
+                }
+            } else {
+                // Failure analyses take elements out of operation in a GraphTransaction on the shared Graph
+                std::unique_lock<std::shared_mutex> lock(networkMutex);
+                if (m == nullptr || seenGeneration != generation) {
+                    m.reset(new Management(network->m));
+                    g = network->g;
+                    seenGeneration = generation;
+                }
+                Batch(g, *m).execute(request, line, out);
+            }
+            out << '\n';
+            if (!sendAll(fd, out.str()))
+                open = false;
+        }
+    }
+
+    // Forget the descriptor before closing it, or run could shut down a new connection given the same number. The
+    // Server is not touched after the lock is released, as run may return by then
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        clientFds.erase(std::find(clientFds.begin(), clientFds.end(), fd));
+        clientsDone.notify_all();
+    }
+    close(fd);
+}
+
+/**
+ * @brief Loads another network and swaps it in once the running queries end
+ * @param args "dataset <n>" or "snapshot <file>"
+ * @details The new network and its baseline are built while the old one still answers queries. Throws a
+ * logic_error if the arguments are not valid or the snapshot cannot be loaded
+ */
+void Server::reload(const std::vector<std::string> &args) {
+    std::lock_guard<std::mutex> reloading(reloadMutex);
+    if (args.size() != 2 || (args[0] != "dataset" && args[0] != "snapshot"))
+        throw std::logic_error("reload takes dataset <n> or snapshot <file>");
+
+    Graph *g = new Graph();
+    std::string results;
+    if (args[0] == "dataset") {
+        Auxiliar::readDataset(g, args[1] == "1");
+    } else if (Snapshot::load(g, args[1])) {
+        results = args[1] + ".results";
+    } else {
+        delete g;
+        throw std::logic_error("could not load the snapshot " + args[1]);
+    }
+    std::unique_ptr<Network> loaded(new Network(g));
+    prepare(*loaded, results);
+
+    Graph *old = network->g;
+    {
+        std::unique_lock<std::shared_mutex> lock(networkMutex);
+        network.swap(loaded);
+        generation++;
+    }
+    loaded.reset();
+    delete old;
+}
+
+/**
+ * @brief Sends a whole buffer, even if the socket takes it in several parts
+ * @param fd
+ * @param data
+ * @return false if the client disconnected
+ */
+bool Server::sendAll(int fd, const std::string &data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            if (n == -1 && errno == EINTR)
+                continue;
+            return false;
+        }
+        sent += (size_t) n;
+    }
+    return true;
+}
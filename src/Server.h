@@ -0,0 +1,59 @@
+#ifndef PROJECT1_SERVER_H
+#define PROJECT1_SERVER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Management.h"
+
+/**
+ * @brief Daemon that keeps a network and its baseline flow loaded and answers queries over a Unix domain socket
+ * @details Each request is one line with a Batch command and each response is its CSV rows, without the header,
+ * followed by an empty line. Besides the Batch commands, there are:
+ *  - reload dataset <n> | reload snapshot <file>: loads another network in place
+ *  - shutdown: stops the daemon
+ *
+ * Every client runs in its own thread with its own copy of the Management, taken from the shared one after the
+ * baseline was computed, so settings such as the algorithm only apply to the client that chose them. The queries of
+ * all clients run one at a time, since failure analyses take elements out of operation inside a GraphTransaction on
+ * the shared Graph, while reading requests and writing responses overlap. A reload builds the new network while
+ * queries still run, swaps it in between two queries and makes every client take a new copy before its next query.
+ */
+class Server {
+public:
+    Server(Graph *g, const std::string &resultsPath = "");
+    ~Server();
+
+    bool run(const std::string &socketPath);
+
+private:
+    struct Network {
+        Graph *g;
+        Management m;
+        Network(Graph *g): g(g), m(g) {}
+    };
+
+    void serveClient(int fd);
+    void reload(const std::vector<std::string> &args);
+    static void prepare(Network &network, const std::string &resultsPath);
+    void stop();
+    static bool sendAll(int fd, const std::string &data);
+
+    std::unique_ptr<Network> network;
+    unsigned long generation = 0; // incremented by every reload
+    std::shared_mutex networkMutex; // exclusive while a query runs or the network is swapped, shared to read its size
+    std::mutex reloadMutex; // one reload at a time
+
+    int listenFd = -1;
+    std::atomic<bool> stopping{false};
+    std::mutex clientsMutex;
+    std::condition_variable clientsDone;
+    std::vector<int> clientFds; // sockets of the connected clients
+};
+
+#endif //PROJECT1_SERVER_H
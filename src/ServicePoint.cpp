@@ -5,11 +5,44 @@
  */
 ServicePoint::ServicePoint() {}
 
+/**
+ * @brief Gets the dense index of the Service Point in its Graph
+ * @return index
+ */
+int ServicePoint::getIndex() const {
+    return index;
+}
+
+/**
+ * @brief Sets the dense index of the Service Point in its Graph
+ * @param index
+ */
+void ServicePoint::setIndex(int index) {
+    this->index = index;
+}
+
+/**
+ * @brief Gets the id of the Service Point code in the symbol table of its Graph
+ * @return symbol
+ */
+uint32_t ServicePoint::getSymbol() const {
+    return symbol;
+}
+
+/**
+ * @brief Sets the id of the Service Point code in the symbol table of its Graph
+ * @param symbol
+ */
+void ServicePoint::setSymbol(uint32_t symbol) {
+    this->symbol = symbol;
+}
+
 /**
  *@brief Adds a pipe to a Service Point
  * @param pipe
  */
 void ServicePoint::addPipe(Pipe * pipe) {
+    pipe->setAdjPosition((int) adj.size());
     adj.push_back(pipe);
 }
 
@@ -18,92 +51,104 @@ void ServicePoint::addPipe(Pipe * pipe) {
  * @param pipe
  */
 void ServicePoint::addIncomingPipe(Pipe * pipe) {
+    pipe->setIncomingPosition((int) incoming.size());
     incoming.push_back(pipe);
 }
 
 /**
- * @brief Removes a incoming pipe from a Service Point
+ * @brief Removes a incoming pipe from a Service Point, moving the last incoming pipe into its place
  * @param pipe
- * @details Time Complexity O(n) n = number of incoming pipes
+ * @details Time Complexity O(1)
  */
 void ServicePoint::removeIncomingPipe(Pipe * pipe) {
-    auto it = incoming.begin();
-    while (it != incoming.end()) {
-        if ((*it) == pipe) {
-            incoming.erase(it);
-            break;
-        } else {
-            it++;
-        }
-    }
+    int position = pipe->getIncomingPosition();
+    Pipe *last = incoming.back();
+    incoming[position] = last;
+    last->setIncomingPosition(position);
+    incoming.pop_back();
+    pipe->setIncomingPosition(-1);
 }
 
 /**
- * @brief Removes an outgoing Pipe
+ * @brief Removes an outgoing Pipe, moving the last outgoing pipe into its place
  * @param pipe
- * @details Time Complexity O(n) n = number of outgoing pipes
+ * @details Time Complexity O(1)
  */
 void ServicePoint::removeOutgoingPipe(Pipe * pipe) {
-    auto it = adj.begin();
-    while (it != adj.end()) {
-        if ((*it) == pipe) {
-            adj.erase(it);
-            break;
-        } else {
-            it++;
-        }
-    }
+    int position = pipe->getAdjPosition();
+    Pipe *last = adj.back();
+    adj[position] = last;
+    last->setAdjPosition(position);
+    adj.pop_back();
+    pipe->setAdjPosition(-1);
 }
 
 /**
- * @brief Gets the adjacent Pipes
- * @return adj
+ * @brief Puts back a removed incoming Pipe at its old position, undoing its removal. The Pipe in that position moves
+ * back to the end
+ * @param pipe
+ * @param position position of the Pipe before it was removed
+ * @details Time Complexity O(1) amortized
  */
-std::vector<Pipe *> ServicePoint::getAdj() const {
-    return this->adj;
+void ServicePoint::restoreIncomingPipe(Pipe * pipe, int position) {
+    if (position < (int) incoming.size()) {
+        Pipe *moved = incoming[position];
+        moved->setIncomingPosition((int) incoming.size());
+        incoming.push_back(moved);
+        incoming[position] = pipe;
+    } else {
+        incoming.push_back(pipe);
+    }
+    pipe->setIncomingPosition(position);
 }
 
 /**
- * @brief Checks if the Service Point is visited
- * @return visited
+ * @brief Puts back a removed outgoing Pipe at its old position, undoing its removal. The Pipe in that position moves
+ * back to the end
+ * @param pipe
+ * @param position position of the Pipe before it was removed
+ * @details Time Complexity O(1) amortized
  */
-bool ServicePoint::isVisited() const {
-    return this->visited;
+void ServicePoint::restoreOutgoingPipe(Pipe * pipe, int position) {
+    if (position < (int) adj.size()) {
+        Pipe *moved = adj[position];
+        moved->setAdjPosition((int) adj.size());
+        adj.push_back(moved);
+        adj[position] = pipe;
+    } else {
+        adj.push_back(pipe);
+    }
+    pipe->setAdjPosition(position);
 }
 
 /**
- * @brief Gets the incoming Pipes
- * @return incoming
+ * @brief Makes room for the Pipes about to be added, when their number is known
+ * @param outgoingCount total number of outgoing Pipes
+ * @param incomingCount total number of incoming Pipes
  */
-std::vector<Pipe *> ServicePoint::getIncoming() const {
-    return this->incoming;
+void ServicePoint::reservePipes(size_t outgoingCount, size_t incomingCount) {
+    adj.reserve(outgoingCount);
+    incoming.reserve(incomingCount);
 }
 
 /**
- * @brief Gets the path to the ServicePoint
- * @return path
+ * @brief Gets the adjacent Pipes, without copying them
+ * @return adj
  */
-Pipe * ServicePoint::getPath() const {
-    return this->path;
+Span<Pipe *> ServicePoint::getAdj() const {
+    return this->adj;
 }
 
 /**
- * @brief Sets ServicePoint as visited or not
- * @param visited
+ * @brief Gets the incoming Pipes, without copying them
+ * @return incoming
  */
-void ServicePoint::setVisited(bool visited) {
-    this->visited = visited;
+Span<Pipe *> ServicePoint::getIncoming() const {
+    return this->incoming;
 }
 
 /**
- * @brief Sets the path to the ServicePoint
- * @param path
- */
-void ServicePoint::setPath(Pipe *path) {
-    this->path=path;
-}
-/**
- * @brief Sets the ServicePoint to operational or not
+ * @brief Sets the ServicePoint to operational or not, called through Graph::setOperational
  * @param b
  */
 void ServicePoint::setOperational(bool b) {
@@ -117,3 +162,13 @@ void ServicePoint::setOperational(bool b) {
 bool ServicePoint::isOperational() const {
     return operational;
 }
+
+/**
+ * @brief Adds the bytes of the Pipe lists and of the code to a report. The object itself is added by each kind of
+ * ServicePoint
+ * @param report
+ */
+void ServicePoint::addMemoryUsage(MemoryReport &report) const {
+    report.adjacency += MemoryReport::vectorBytes(adj) + MemoryReport::vectorBytes(incoming);
+    report.strings += MemoryReport::stringBytes(code);
+}
@@ -2,8 +2,11 @@
 #define PROJECT1_SERVICEPOINT_H
 
 #include "Pipe.h"
+#include "Span.h"
+#include "MemoryReport.h"
 #include <vector>
 #include <string>
+#include <cstdint>
 
 class Pipe;
 
@@ -13,35 +16,43 @@ class Pipe;
 class ServicePoint {
 public:
     ServicePoint();
+    virtual ~ServicePoint() = default;
 
     virtual std::string getCode() const = 0;
+    int getIndex() const;
+    void setIndex(int index);
+    uint32_t getSymbol() const;
+    void setSymbol(uint32_t symbol);
 
     void addPipe(Pipe * pipe);
     void addIncomingPipe(Pipe * pipe);
     void removeIncomingPipe(Pipe * pipe);
     void removeOutgoingPipe(Pipe * pipe);
+    void restoreIncomingPipe(Pipe * pipe, int position);
+    void restoreOutgoingPipe(Pipe * pipe, int position);
+    void reservePipes(size_t outgoingCount, size_t incomingCount);
 
-    std::vector<Pipe *> getIncoming() const;
+    Span<Pipe *> getIncoming() const;
 
-    std::vector<Pipe *> getAdj() const;
-    bool isVisited() const;
+    Span<Pipe *> getAdj() const;
     bool isOperational() const;
-    Pipe* getPath() const;
 
-    void setVisited(bool visited);
-    void setPath(Pipe *path);
+    virtual void addMemoryUsage(MemoryReport &report) const;
+
+private:
+    // Only the Graph changes it, so that every change bumps its version
+    friend class Graph;
     void setOperational(bool b);
 
 protected:
     std::string code;
+    int index = -1; // dense index given by the Graph
+    uint32_t symbol = UINT32_MAX; // id of the code in the symbol table of the Graph
     std::vector<Pipe *> adj{}; // outgoing Pipes
     std::vector<Pipe *> incoming{}; // incoming Pipes
 
     // auxiliary fields
-    bool visited = false;
     bool operational=true;
-
-    Pipe* path=nullptr;
 };
 
 #endif //PROJECT1_SERVICEPOINT_H
@@ -0,0 +1,228 @@
+#include "Snapshot.h"
+#include "MappedFile.h"
+#include "TraceRecorder.h"
+#include <cstring>
+#include <fstream>
+#include <string_view>
+#include <unordered_set>
+
+static const char MAGIC[8] = {'W', 'S', 'N', 'S', 'N', 'A', 'P', '\0'};
+
+/**
+ * @brief Rounds a file offset up to a multiple of 8
+ * @param offset
+ * @return aligned offset
+ */
+static uint64_t align(uint64_t offset) {
+    return (offset + 7) & ~(uint64_t) 7;
+}
+
+/**
+ * @brief Writes a Graph to a snapshot file
+ * @param g
+ * @param path
+ * @return false if the file could not be written
+ * @details Time Complexity O(S+P) S = number of ServicePoints, P = number of Pipes
+ */
+bool Snapshot::save(Graph *g, const std::string &path) {
+    TRACE_SCOPE("load", "Snapshot::save");
+    Span<ServicePoint *> servicePoints = g->getServicePointSet();
+    std::vector<uint32_t> position(g->getServicePointIndexBound());
+    for (size_t i = 0; i < servicePoints.size(); i++)
+        position[servicePoints[i]->getIndex()] = (uint32_t) i;
+
+    // ServicePoint table and string pool
+    std::string pool;
+    auto addString = [&pool](const std::string &s) {
+        StringRef ref{(uint32_t) pool.size(), (uint32_t) s.size()};
+        pool += s;
+        return ref;
+    };
+    std::vector<ServicePointRecord> records;
+    records.reserve(servicePoints.size());
+    for (ServicePoint *v : servicePoints) {
+        ServicePointRecord record{};
+        record.code = addString(v->getCode());
+        if (auto *r = dynamic_cast<Reservoir *>(v)) {
+            record.kind = RESERVOIR;
+            record.id = addString(r->getId());
+            record.name = addString(r->getName());
+            record.municipality = addString(r->getMunicipality());
+            record.amount = r->getMaxDelivery();
+        } else if (auto *c = dynamic_cast<City *>(v)) {
+            record.kind = CITY;
+            record.id = addString(c->getId());
+            record.name = addString(c->getName());
+            record.amount = c->getDemand();
+            record.population = c->getPopulation();
+        } else {
+            record.kind = STATION;
+            record.id = addString(((Station *) v)->getId());
+        }
+        records.push_back(record);
+    }
+
+    // Rank every Pipe, the second Pipe of a bidirectional pair goes with the first one
+    std::vector<int> rank(g->getPipeIndexBound(), -1);
+    uint32_t pipeCount = 0;
+    for (Pipe *e : g->getPipeSet()) {
+        if (e->getReverse() != nullptr && rank[e->getReverse()->getIndex()] != -1)
+            continue;
+        rank[e->getIndex()] = (int) pipeCount++;
+    }
+
+    // Outgoing Pipes in CSR form
+    std::vector<uint32_t> arcOffsets(servicePoints.size() + 1, 0);
+    std::vector<ArcRecord> arcs;
+    arcs.reserve(pipeCount);
+    for (size_t i = 0; i < servicePoints.size(); i++) {
+        for (Pipe *e : servicePoints[i]->getAdj()) {
+            if (rank[e->getIndex()] == -1)
+                continue;
+            ArcRecord arc{};
+            arc.dest = position[e->getDest()->getIndex()];
+            arc.capacity = (int32_t) e->getCapacity();
+            arc.bidirectional = e->getReverse() != nullptr;
+            arc.rank = (uint32_t) rank[e->getIndex()];
+            arcs.push_back(arc);
+        }
+        arcOffsets[i + 1] = (uint32_t) arcs.size();
+    }
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.formatVersion = FORMAT_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.servicePointCount = (uint32_t) records.size();
+    header.pipeCount = pipeCount;
+    header.stringPoolSize = pool.size();
+    header.servicePointsOffset = align(sizeof(Header));
+    header.stringPoolOffset = align(header.servicePointsOffset + records.size() * sizeof(ServicePointRecord));
+    header.arcOffsetsOffset = align(header.stringPoolOffset + pool.size());
+    header.arcsOffset = align(header.arcOffsetsOffset + arcOffsets.size() * sizeof(uint32_t));
+    header.fileSize = header.arcsOffset + arcs.size() * sizeof(ArcRecord);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    uint64_t written = 0;
+    auto write = [&](uint64_t offset, const void *data, size_t size) {
+        static const char padding[8] = {};
+        file.write(padding, (std::streamsize) (offset - written));
+        file.write((const char *) data, (std::streamsize) size);
+        written = offset + size;
+    };
+    write(0, &header, sizeof(Header));
+    write(header.servicePointsOffset, records.data(), records.size() * sizeof(ServicePointRecord));
+    write(header.stringPoolOffset, pool.data(), pool.size());
+    write(header.arcOffsetsOffset, arcOffsets.data(), arcOffsets.size() * sizeof(uint32_t));
+    write(header.arcsOffset, arcs.data(), arcs.size() * sizeof(ArcRecord));
+    file.close();
+    return !file.fail();
+}
+
+/**
+ * @brief Adds the network of a snapshot file to a Graph, reading the mapped file in place
+ * @param g
+ * @param path
+ * @return false, leaving the Graph untouched, if the file is missing, of another format version or damaged
+ * @details Time Complexity O(S+P) S = number of ServicePoints, P = number of Pipes
+ */
+bool Snapshot::load(Graph *g, const std::string &path) {
+    TRACE_SCOPE("load", "Snapshot::load");
+    MappedFile file(path);
+    std::string_view contents = file.getContents();
+    if (contents.size() < sizeof(Header))
+        return false;
+    const auto *header = (const Header *) contents.data();
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->formatVersion != FORMAT_VERSION
+        || header->byteOrder != BYTE_ORDER_MARK || header->fileSize != contents.size())
+        return false;
+    uint64_t servicePointsEnd = header->servicePointsOffset + (uint64_t) header->servicePointCount * sizeof(ServicePointRecord);
+    uint64_t arcOffsetsEnd = header->arcOffsetsOffset + ((uint64_t) header->servicePointCount + 1) * sizeof(uint32_t);
+    if (header->servicePointsOffset < sizeof(Header) || servicePointsEnd > header->stringPoolOffset
+        || header->stringPoolOffset + header->stringPoolSize > header->arcOffsetsOffset
+        || arcOffsetsEnd > header->arcsOffset || header->arcsOffset > header->fileSize
+        || (header->servicePointsOffset | header->arcOffsetsOffset | header->arcsOffset) % 8 != 0)
+        return false;
+
+    const auto *records = (const ServicePointRecord *) (contents.data() + header->servicePointsOffset);
+    const char *pool = contents.data() + header->stringPoolOffset;
+    const auto *arcOffsets = (const uint32_t *) (contents.data() + header->arcOffsetsOffset);
+    const auto *arcs = (const ArcRecord *) (contents.data() + header->arcsOffset);
+    uint32_t servicePointCount = header->servicePointCount;
+    uint32_t pipeCount = header->pipeCount;
+
+    // Check every reference before changing the Graph
+    auto validString = [&](StringRef ref) {
+        return (uint64_t) ref.offset + ref.length <= header->stringPoolSize;
+    };
+    if (header->arcsOffset + (uint64_t) pipeCount * sizeof(ArcRecord) != header->fileSize
+        || arcOffsets[0] != 0 || arcOffsets[servicePointCount] != pipeCount)
+        return false;
+    std::unordered_set<std::string_view> codes;
+    for (uint32_t i = 0; i < servicePointCount; i++) {
+        const ServicePointRecord &record = records[i];
+        if (record.kind > CITY || !validString(record.code) || !validString(record.id) || !validString(record.name)
+            || !validString(record.municipality) || arcOffsets[i] > arcOffsets[i + 1])
+            return false;
+        std::string_view code(pool + record.code.offset, record.code.length);
+        if (!codes.insert(code).second || g->getServicePointBySymbol(g->getSymbol(code)) != nullptr)
+            return false;
+    }
+    std::vector<const ArcRecord *> byRank(pipeCount, nullptr);
+    std::vector<uint32_t> origin(pipeCount);
+    for (uint32_t i = 0; i < servicePointCount; i++) {
+        for (uint32_t a = arcOffsets[i]; a < arcOffsets[i + 1]; a++) {
+            if (arcs[a].dest >= servicePointCount || arcs[a].rank >= pipeCount || byRank[arcs[a].rank] != nullptr)
+                return false;
+            byRank[arcs[a].rank] = &arcs[a];
+            origin[arcs[a].rank] = i;
+        }
+    }
+
+    // Add the ServicePoints in table order and the Pipes in rank order
+    auto str = [pool](StringRef ref) {
+        return std::string(pool + ref.offset, ref.length);
+    };
+    std::vector<uint32_t> outDegree(servicePointCount, 0);
+    std::vector<uint32_t> inDegree(servicePointCount, 0);
+    for (uint32_t i = 0; i < servicePointCount; i++) {
+        for (uint32_t a = arcOffsets[i]; a < arcOffsets[i + 1]; a++) {
+            outDegree[i]++;
+            inDegree[arcs[a].dest]++;
+            if (arcs[a].bidirectional) {
+                outDegree[arcs[a].dest]++;
+                inDegree[i]++;
+            }
+        }
+    }
+    g->reserveServicePoints(servicePointCount);
+    std::vector<uint32_t> symbol(servicePointCount);
+    for (uint32_t i = 0; i < servicePointCount; i++) {
+        const ServicePointRecord &record = records[i];
+        ServicePoint *v;
+        if (record.kind == RESERVOIR) {
+            auto *r = new Reservoir(str(record.name), str(record.municipality), str(record.id), str(record.code), record.amount);
+            g->addReservoir(r);
+            v = r;
+        } else if (record.kind == CITY) {
+            auto *c = new City(str(record.name), str(record.id), str(record.code), record.amount, record.population);
+            g->addCity(c);
+            v = c;
+        } else {
+            auto *s = new Station(str(record.id), str(record.code));
+            g->addStation(s);
+            v = s;
+        }
+        v->reservePipes(outDegree[i], inDegree[i]);
+        symbol[i] = v->getSymbol();
+    }
+    g->reservePipes(2 * (size_t) pipeCount);
+    for (uint32_t k = 0; k < pipeCount; k++) {
+        const ArcRecord &arc = *byRank[k];
+        if (arc.bidirectional)
+            g->addBidirectionalPipe(symbol[origin[k]], symbol[arc.dest], arc.capacity);
+        else
+            g->addPipe(symbol[origin[k]], symbol[arc.dest], arc.capacity);
+    }
+    return true;
+}
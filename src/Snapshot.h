@@ -0,0 +1,65 @@
+#ifndef PROJECT1_SNAPSHOT_H
+#define PROJECT1_SNAPSHOT_H
+
+#include <cstdint>
+#include <string>
+#include "Graph.h"
+
+/**
+ * @brief Binary snapshot of a network, to start without parsing the CSV files
+ * @details The file holds a header, a table of ServicePoints, a pool with all their strings and the Pipes in CSR
+ * form: the outgoing Pipes of each ServicePoint are contiguous, after an offset table. A bidirectional Pipe is
+ * stored once, with a flag. Every section is aligned to 8 bytes and in native byte order, so a mapped file is read
+ * in place. Each Pipe also keeps its rank among the Pipes of the Graph, so the loaded Graph lists its Pipes in the
+ * same order as the saved one and the queries give the same results.
+ */
+class Snapshot {
+public:
+    static const uint32_t FORMAT_VERSION = 1;
+
+    static bool save(Graph *g, const std::string &path);
+    static bool load(Graph *g, const std::string &path);
+
+private:
+    struct Header {
+        char magic[8];
+        uint32_t formatVersion;
+        uint32_t byteOrder; // BYTE_ORDER_MARK as written, to reject files from machines with another byte order
+        uint32_t servicePointCount;
+        uint32_t pipeCount;
+        uint64_t stringPoolSize;
+        uint64_t servicePointsOffset;
+        uint64_t stringPoolOffset;
+        uint64_t arcOffsetsOffset;
+        uint64_t arcsOffset;
+        uint64_t fileSize;
+    };
+
+    struct StringRef {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    enum Kind : uint32_t { RESERVOIR, STATION, CITY };
+
+    struct ServicePointRecord {
+        uint32_t kind;
+        StringRef code;
+        StringRef id;
+        StringRef name; // Reservoirs and Cities
+        StringRef municipality; // Reservoirs
+        int32_t amount; // maximum delivery of a Reservoir, demand of a City
+        int32_t population; // Cities
+    };
+
+    struct ArcRecord {
+        uint32_t dest; // position of the destination in the ServicePoint table
+        int32_t capacity;
+        uint32_t bidirectional;
+        uint32_t rank; // position among the Pipes of the Graph, counting a bidirectional Pipe once
+    };
+
+    static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+};
+
+#endif //PROJECT1_SNAPSHOT_H
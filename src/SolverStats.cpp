@@ -0,0 +1,59 @@
+#include <iomanip>
+#include "SolverStats.h"
+
+/**
+ * @brief Adds the counters and times of other solves, such as those of a worker
+ * @param other
+ */
+void SolverStats::add(const SolverStats &other) {
+    searches += other.searches;
+    arcsScanned += other.arcsScanned;
+    augmentations += other.augmentations;
+    relabels += other.relabels;
+    for (int i = 0; i < PHASE_COUNT; i++)
+        phaseSeconds[i] += other.phaseSeconds[i];
+}
+
+/**
+ * @brief Prints the counters and the time of each phase on one line
+ * @param out
+ */
+void SolverStats::print(std::ostream &out) const {
+    if (!ENABLED)
+        return;
+    std::ios_base::fmtflags flags = out.flags();
+    out << "Solver: " << searches << " searches, " << arcsScanned << " arcs scanned, " << augmentations
+        << " augmentations, " << relabels << " relabels; " << std::fixed << std::setprecision(3)
+        << "setup " << phaseSeconds[(int) SolverPhase::SETUP] * 1000 << " ms, solve "
+        << phaseSeconds[(int) SolverPhase::SOLVE] * 1000 << " ms, teardown "
+        << phaseSeconds[(int) SolverPhase::TEARDOWN] * 1000 << " ms\n";
+    out.flags(flags);
+}
+
+/**
+ * @brief Starts timing a phase, pausing the one being timed
+ * @param stats
+ * @param phase
+ */
+PhaseTimer::PhaseTimer(SolverStats &stats, SolverPhase phase) : stats(stats), previousPhase(stats.currentPhase) {
+    charge();
+    stats.currentPhase = (int) phase;
+}
+
+/**
+ * @brief Stops timing the phase and resumes the one around it
+ */
+PhaseTimer::~PhaseTimer() {
+    charge();
+    stats.currentPhase = previousPhase;
+}
+
+/**
+ * @brief Charges the time since the last change of phase to the phase being timed
+ */
+void PhaseTimer::charge() {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (stats.currentPhase >= 0)
+        stats.phaseSeconds[stats.currentPhase] += std::chrono::duration<double>(now - stats.phaseStart).count();
+    stats.phaseStart = now;
+}
@@ -0,0 +1,70 @@
+#ifndef PROJECT1_SOLVERSTATS_H
+#define PROJECT1_SOLVERSTATS_H
+
+#include <chrono>
+#include <ostream>
+
+/**
+ * @brief Phases a solve spends its time in
+ */
+enum class SolverPhase {
+    SETUP, // residual graph snapshot, sizing and resetting the FlowState, failing elements, restoring the baseline
+    SOLVE, // max flow engines, repairs and balancing
+    TEARDOWN // restoring failed elements and collecting the flow per City
+};
+
+/**
+ * @brief Work counters and phase times of the solves done in a FlowState
+ * @details Only filled when the project is configured with PROJECT1_SOLVER_STATS. Otherwise the SOLVER_COUNT and
+ * SOLVER_PHASE macros compile to nothing and every field stays 0.
+ */
+struct SolverStats {
+#ifdef PROJECT1_SOLVER_STATS
+    static constexpr bool ENABLED = true;
+#else
+    static constexpr bool ENABLED = false;
+#endif
+    static constexpr int PHASE_COUNT = 3;
+
+    unsigned long searches = 0; // breadth-first passes: augmenting path searches, level graphs and global relabels
+    unsigned long arcsScanned = 0;
+    unsigned long augmentations = 0; // augmenting paths and pushes
+    unsigned long relabels = 0;
+    double phaseSeconds[PHASE_COUNT] = {};
+
+    // Phase being timed, so that a nested phase pauses the one around it
+    int currentPhase = -1;
+    std::chrono::steady_clock::time_point phaseStart;
+
+    void add(const SolverStats &other);
+    void print(std::ostream &out) const;
+};
+
+/**
+ * @brief Charges the time of a scope to a solver phase. The phase around it is paused meanwhile, so no time is
+ * counted twice
+ */
+class PhaseTimer {
+public:
+    PhaseTimer(SolverStats &stats, SolverPhase phase);
+    ~PhaseTimer();
+
+    PhaseTimer(const PhaseTimer &) = delete;
+    PhaseTimer & operator=(const PhaseTimer &) = delete;
+
+private:
+    void charge();
+
+    SolverStats &stats;
+    int previousPhase;
+};
+
+#ifdef PROJECT1_SOLVER_STATS
+#define SOLVER_COUNT(state, counter, n) ((state).getStats().counter += (n))
+#define SOLVER_PHASE(state, phase) PhaseTimer solverPhaseTimer((state).getStats(), phase)
+#else
+#define SOLVER_COUNT(state, counter, n) ((void) 0)
+#define SOLVER_PHASE(state, phase) ((void) 0)
+#endif
+
+#endif //PROJECT1_SOLVERSTATS_H
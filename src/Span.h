@@ -0,0 +1,30 @@
+#ifndef PROJECT1_SPAN_H
+#define PROJECT1_SPAN_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Read-only view over contiguous elements owned by someone else, such as the Pipes of a ServicePoint or the
+ * sets of a Graph. It is only valid until its owner changes, so it must not be kept across additions or removals
+ */
+template <typename T>
+class Span {
+public:
+    Span(): first(nullptr), last(nullptr) {}
+    Span(const std::vector<T> &v): first(v.data()), last(v.data() + v.size()) {}
+
+    const T * begin() const { return first; }
+    const T * end() const { return last; }
+    std::size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+    const T & operator[](std::size_t i) const { return first[i]; }
+    const T & front() const { return *first; }
+    const T & back() const { return *(last - 1); }
+
+private:
+    const T *first;
+    const T *last;
+};
+
+#endif //PROJECT1_SPAN_H
@@ -22,3 +22,14 @@ std::string Station::getId() {
 std::string Station::getCode() const {
     return this->code;
 }
+
+/**
+ * @brief Adds the bytes of the Station, its Pipe lists and its strings to a report
+ * @param report
+ */
+void Station::addMemoryUsage(MemoryReport &report) const {
+    ServicePoint::addMemoryUsage(report);
+    report.nodes += sizeof(Station);
+    report.strings += MemoryReport::stringBytes(id);
+    report.strings += MemoryReport::stringBytes(code);
+}
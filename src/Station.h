@@ -14,6 +14,8 @@ public:
     std::string getId();
     std::string getCode() const;
 
+    void addMemoryUsage(MemoryReport &report) const override;
+
 private:
     std::string id;
     std::string code;
@@ -0,0 +1,59 @@
+#include "SymbolTable.h"
+
+/**
+ * @brief Gets the id of a string, giving it the next id if it was not interned yet
+ * @param name
+ * @return id
+ * @details Time Complexity O(|name|) on average
+ */
+uint32_t SymbolTable::intern(std::string_view name) {
+    auto it = ids.find(name);
+    if (it != ids.end())
+        return it->second;
+    uint32_t id = (uint32_t) names.size();
+    names.emplace_back(name);
+    ids.emplace(names.back(), id);
+    return id;
+}
+
+/**
+ * @brief Gets the id of a string without interning it
+ * @param name
+ * @return id, NONE if the string was never interned
+ * @details Time Complexity O(|name|) on average
+ */
+uint32_t SymbolTable::find(std::string_view name) const {
+    auto it = ids.find(name);
+    return it == ids.end() ? NONE : it->second;
+}
+
+/**
+ * @brief Gets the string of an id
+ * @param id lower than size()
+ * @return name
+ */
+const std::string & SymbolTable::getName(uint32_t id) const {
+    return names[id];
+}
+
+/**
+ * @brief Gets the number of interned strings, which is also the bound of the ids
+ * @return size
+ */
+uint32_t SymbolTable::size() const {
+    return (uint32_t) names.size();
+}
+
+/**
+ * @brief Adds the bytes of the names to the strings of a report, and those of the lookup table to its indexes
+ * @param report
+ * @details The lookup table is estimated as its buckets plus one node per name, holding the next node, the entry
+ * and its hash
+ */
+void SymbolTable::addMemoryUsage(MemoryReport &report) const {
+    for (const std::string &name : names)
+        report.strings += MemoryReport::stringBytes(name);
+    report.indexes += names.size() * sizeof(std::string);
+    report.indexes += ids.bucket_count() * sizeof(void *);
+    report.indexes += ids.size() * (sizeof(void *) + sizeof(std::pair<const std::string_view, uint32_t>) + sizeof(std::size_t));
+}
@@ -0,0 +1,31 @@
+#ifndef PROJECT1_SYMBOLTABLE_H
+#define PROJECT1_SYMBOLTABLE_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "MemoryReport.h"
+
+/**
+ * @brief Interns strings, such as ServicePoint codes, giving each distinct one a dense id
+ * @details Ids start at 0 and are never given again, so they can index arrays and be packed into integer keys.
+ * The strings are hashed once, when interned or looked up, and lookups take a string_view so they do not allocate.
+ */
+class SymbolTable {
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    uint32_t intern(std::string_view name);
+    uint32_t find(std::string_view name) const;
+    const std::string & getName(uint32_t id) const;
+    uint32_t size() const;
+    void addMemoryUsage(MemoryReport &report) const;
+
+private:
+    std::deque<std::string> names; // name of each id, a deque so the views in ids stay valid
+    std::unordered_map<std::string_view, uint32_t> ids;
+};
+
+#endif //PROJECT1_SYMBOLTABLE_H
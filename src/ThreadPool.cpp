@@ -0,0 +1,129 @@
+#include <algorithm>
+#include "ThreadPool.h"
+
+/**
+ * @brief ThreadPool Constructor, starts the worker threads
+ * @param threads number of workers, at least one
+ */
+ThreadPool::ThreadPool(unsigned threads) {
+    threads = std::max(1u, threads);
+    for (unsigned i = 0; i < threads; i++) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    for (unsigned i = 0; i < threads; i++) {
+        this->threads.emplace_back(&ThreadPool::work, this, i);
+    }
+}
+
+/**
+ * @brief ThreadPool Destructor, stops and joins the worker threads
+ */
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    start.notify_all();
+    for (std::thread &t : threads) {
+        t.join();
+    }
+}
+
+/**
+ * @brief Gets the number of workers
+ * @return number of workers
+ */
+unsigned ThreadPool::size() const {
+    return threads.size();
+}
+
+/**
+ * @brief Runs job(task, worker) for every task in [0, count) and waits for all of them. The worker index can be used
+ * to select per-worker scratch state. The first exception thrown by a task is rethrown here
+ * @param count number of tasks
+ * @param job function to run
+ */
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t task, unsigned worker)> &job) {
+    if (count == 0)
+        return;
+
+    this->job = &job;
+    error = nullptr;
+    remaining = count;
+
+    // Contiguous block of tasks for each worker
+    size_t block = (count + workers.size() - 1) / workers.size();
+    for (size_t w = 0; w < workers.size(); w++) {
+        std::lock_guard<std::mutex> lock(workers[w]->mutex);
+        for (size_t task = w * block; task < std::min(count, (w + 1) * block); task++) {
+            workers[w]->tasks.push_back(task);
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    generation++;
+    start.notify_all();
+    done.wait(lock, [this] { return remaining == 0; });
+    this->job = nullptr;
+    if (error)
+        std::rethrow_exception(error);
+}
+
+/**
+ * @brief Takes the next task of a worker, stealing from the other workers when its own deque is empty
+ * @param id worker index
+ * @param task set to the task taken
+ * @return True if a task was taken
+ */
+bool ThreadPool::popTask(unsigned id, size_t &task) {
+    {
+        std::lock_guard<std::mutex> lock(workers[id]->mutex);
+        if (!workers[id]->tasks.empty()) {
+            task = workers[id]->tasks.front();
+            workers[id]->tasks.pop_front();
+            return true;
+        }
+    }
+    for (size_t i = 1; i < workers.size(); i++) {
+        Worker &victim = *workers[(id + i) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Worker loop, waits for a batch and runs tasks until there are none left to take or steal
+ * @param id worker index
+ */
+void ThreadPool::work(unsigned id) {
+    unsigned seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            start.wait(lock, [&] { return stop || generation != seen; });
+            if (stop)
+                return;
+            seen = generation;
+        }
+
+        size_t task;
+        while (popTask(id, task)) {
+            try {
+                (*job)(task, id);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error)
+                    error = std::current_exception();
+            }
+            if (--remaining == 0) {
+                std::lock_guard<std::mutex> lock(mutex);
+                done.notify_all();
+            }
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef PROJECT1_THREADPOOL_H
+#define PROJECT1_THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <atomic>
+
+/**
+ * @brief Work-stealing pool of threads that runs a batch of independent tasks
+ * @details Each worker starts with a contiguous block of tasks in its own deque and takes them from the front.
+ * A worker whose deque is empty steals from the back of the others, so uneven tasks still keep every thread busy.
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    unsigned size() const;
+    void parallelFor(size_t count, const std::function<void(size_t task, unsigned worker)> &job);
+
+private:
+    struct Worker {
+        std::deque<size_t> tasks;
+        std::mutex mutex;
+    };
+
+    void work(unsigned id);
+    bool popTask(unsigned id, size_t &task);
+
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<Worker>> workers;
+    const std::function<void(size_t, unsigned)> *job = nullptr;
+
+    std::mutex mutex;
+    std::condition_variable start;
+    std::condition_variable done;
+    unsigned generation = 0;
+    bool stop = false;
+    std::atomic<size_t> remaining{0};
+    std::exception_ptr error;
+};
+
+#endif //PROJECT1_THREADPOOL_H
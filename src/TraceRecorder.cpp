@@ -0,0 +1,168 @@
+#include <fstream>
+#include <iomanip>
+#include "TraceRecorder.h"
+
+/**
+ * @brief Gets the recorder of the program
+ * @return recorder
+ */
+TraceRecorder & TraceRecorder::instance() {
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+/**
+ * @brief Starts recording spans
+ */
+void TraceRecorder::start() {
+    enabled.store(true, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Stops recording spans. The spans recorded so far are kept
+ */
+void TraceRecorder::stop() {
+    enabled.store(false, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Checks if spans are being recorded
+ * @return enabled
+ */
+bool TraceRecorder::isEnabled() const {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Drops every span recorded. No thread may be recording meanwhile
+ */
+void TraceRecorder::clear() {
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    for (std::unique_ptr<ThreadBuffer> &buffer : buffers)
+        buffer->events.clear();
+}
+
+/**
+ * @brief Gets the time since the recorder was created
+ * @return microseconds
+ */
+double TraceRecorder::now() const {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - origin).count();
+}
+
+/**
+ * @brief Records a span in the buffer of the calling thread
+ * @param category
+ * @param name
+ * @param start microseconds since the recorder was created
+ * @param end microseconds since the recorder was created
+ */
+void TraceRecorder::record(const char *category, std::string name, double start, double end) {
+    threadBuffer().events.push_back({category, std::move(name), start, end - start});
+}
+
+/**
+ * @brief Gets the buffer of the calling thread, creating it on its first span
+ * @return buffer
+ */
+TraceRecorder::ThreadBuffer & TraceRecorder::threadBuffer() {
+    thread_local ThreadBuffer *buffer = nullptr;
+    if (buffer == nullptr) {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        buffers.push_back(std::unique_ptr<ThreadBuffer>(new ThreadBuffer{(unsigned) buffers.size() + 1, {}}));
+        buffer = buffers.back().get();
+    }
+    return *buffer;
+}
+
+/**
+ * @brief Writes a string as a JSON string literal
+ * @param out
+ * @param text
+ */
+static void writeJsonString(std::ostream &out, const std::string &text) {
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\')
+            out << '\\' << c;
+        else if ((unsigned char) c < 0x20)
+            out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int) c << std::dec << std::setfill(' ');
+        else
+            out << c;
+    }
+    out << '"';
+}
+
+/**
+ * @brief Writes every span recorded as a Chrome trace event file. No thread may be recording meanwhile
+ * @param path
+ * @return false if the file could not be written
+ * @details Time Complexity O(E), E = number of spans
+ */
+bool TraceRecorder::write(const std::string &path) {
+    std::ofstream out(path);
+    if (!out)
+        return false;
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << std::fixed << std::setprecision(3);
+    bool first = true;
+    for (const std::unique_ptr<ThreadBuffer> &buffer : buffers) {
+        out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+            << ",\"args\":{\"name\":\"" << (buffer->tid == 1 ? "main" : "thread " + std::to_string(buffer->tid))
+            << "\"}}";
+        first = false;
+        for (const Event &event : buffer->events) {
+            out << ",\n{\"name\":";
+            writeJsonString(out, event.name);
+            out << ",\"cat\":\"" << event.category << "\",\"ph\":\"X\",\"ts\":" << event.start << ",\"dur\":"
+                << event.duration << ",\"pid\":1,\"tid\":" << buffer->tid << "}";
+        }
+    }
+    out << "\n]}\n";
+    return (bool) out;
+}
+
+/**
+ * @brief Begins a span, if the recorder is on. The name is only copied then, so a disabled span allocates nothing
+ * @param category
+ * @param name
+ */
+TraceScope::TraceScope(const char *category, const char *name) : category(category) {
+    TraceRecorder &recorder = TraceRecorder::instance();
+    if (recorder.isEnabled()) {
+        this->name = name;
+        start = recorder.now();
+    }
+}
+
+/**
+ * @brief Begins a span with a name built at run time, if the recorder is on
+ * @param category
+ * @param name
+ */
+TraceScope::TraceScope(const char *category, const std::string &name) : category(category) {
+    TraceRecorder &recorder = TraceRecorder::instance();
+    if (recorder.isEnabled()) {
+        this->name = name;
+        start = recorder.now();
+    }
+}
+
+/**
+ * @brief Ends the span, if it was not ended yet
+ */
+TraceScope::~TraceScope() {
+    end();
+}
+
+/**
+ * @brief Ends the span and records it. Later calls do nothing
+ */
+void TraceScope::end() {
+    if (start < 0)
+        return;
+    TraceRecorder &recorder = TraceRecorder::instance();
+    recorder.record(category, std::move(name), start, recorder.now());
+    start = -1;
+}
@@ -0,0 +1,75 @@
+#ifndef PROJECT1_TRACERECORDER_H
+#define PROJECT1_TRACERECORDER_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Records timed spans of the program and writes them as Chrome trace events, which chrome://tracing and
+ * Perfetto show as a timeline with one track per thread
+ * @details Recording is off until start is called, and a span costs a single check while it is off. Each thread
+ * appends its spans to its own buffer, so recording takes no lock once a thread has recorded its first span.
+ */
+class TraceRecorder {
+public:
+    static TraceRecorder & instance();
+
+    void start();
+    void stop();
+    bool isEnabled() const;
+    void clear();
+    bool write(const std::string &path);
+
+    double now() const;
+    void record(const char *category, std::string name, double start, double end);
+
+private:
+    struct Event {
+        const char *category;
+        std::string name;
+        double start; // microseconds since the recorder started
+        double duration; // microseconds
+    };
+    struct ThreadBuffer {
+        unsigned tid;
+        std::vector<Event> events;
+    };
+
+    TraceRecorder() = default;
+    ThreadBuffer & threadBuffer();
+
+    std::atomic<bool> enabled{false};
+    std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+    std::mutex buffersMutex; // guards the list of buffers, not their events
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+/**
+ * @brief Records the lifetime of a scope as a span, if the TraceRecorder is on when the scope begins. The span can
+ * also be ended earlier, such as before waiting for the user
+ */
+class TraceScope {
+public:
+    TraceScope(const char *category, const char *name);
+    TraceScope(const char *category, const std::string &name);
+    ~TraceScope();
+    void end();
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope & operator=(const TraceScope &) = delete;
+
+private:
+    const char *category;
+    std::string name; // only copied when the recorder is on
+    double start = -1; // -1 when the recorder was off
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(category, name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(category, name)
+
+#endif //PROJECT1_TRACERECORDER_H
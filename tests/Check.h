@@ -0,0 +1,50 @@
+#ifndef PROJECT1_CHECK_H
+#define PROJECT1_CHECK_H
+
+#include <iostream>
+
+/**
+ * @brief Number of failed checks of the running test
+ * @return count
+ */
+inline int & checkFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+/**
+ * @brief Checks a condition, printing where it failed without stopping the test
+ */
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << __FILE__ << ':' << __LINE__ << ": CHECK(" #condition ") failed\n"; \
+            checkFailures()++; \
+        } \
+    } while (0)
+
+/**
+ * @brief Checks that two values are equal, printing both if they are not
+ */
+#define CHECK_EQ(actual, expected) \
+    do { \
+        auto checkActual = (actual); \
+        auto checkExpected = (expected); \
+        if (!(checkActual == checkExpected)) { \
+            std::cerr << __FILE__ << ':' << __LINE__ << ": CHECK_EQ(" #actual ", " #expected ") failed: " \
+                      << checkActual << " != " << checkExpected << '\n'; \
+            checkFailures()++; \
+        } \
+    } while (0)
+
+/**
+ * @brief Prints the outcome of a test
+ * @return exit code of the test, 1 if any check failed
+ */
+inline int checkResult() {
+    if (checkFailures() > 0)
+        std::cerr << checkFailures() << " check(s) failed\n";
+    return checkFailures() == 0 ? 0 : 1;
+}
+
+#endif //PROJECT1_CHECK_H
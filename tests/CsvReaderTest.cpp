@@ -0,0 +1,123 @@
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include "Check.h"
+#include "../src/CsvReader.h"
+#include "../src/Auxiliar.h"
+#include "../src/City.h"
+#include "../src/Reservoir.h"
+
+/**
+ * @brief A quoted field keeps its commas and loses its quotes, and the number in it drops the thousands separator
+ */
+static void testQuotedField() {
+    CsvReader csv("Funchal,1,C_1,\"2,517\",x\n");
+    CHECK(csv.nextRow());
+    CHECK_EQ(csv.nextField(), "Funchal");
+    CHECK_EQ(csv.nextField(), "1");
+    CHECK_EQ(csv.nextField(), "C_1");
+    std::string_view population = csv.nextField();
+    CHECK_EQ(population, "2,517");
+    CHECK_EQ(CsvReader::toInt(population), 2517);
+    CHECK_EQ(csv.nextField(), "x");
+    CHECK_EQ(csv.nextField(), "");
+    CHECK(!csv.nextRow());
+}
+
+/**
+ * @brief CRLF line endings are not part of the last field, and empty rows are skipped
+ */
+static void testCrlf() {
+    CsvReader csv("a,b\r\n\r\n1,2\r\n");
+    CHECK(csv.nextRow());
+    CHECK_EQ(csv.nextField(), "a");
+    CHECK_EQ(csv.nextField(), "b");
+    CHECK(csv.nextRow());
+    CHECK_EQ(csv.nextField(), "1");
+    CHECK_EQ(csv.nextField(), "2");
+    CHECK(!csv.nextRow());
+}
+
+/**
+ * @brief The last row is read and counted without a trailing line ending
+ */
+static void testMissingTrailingNewline() {
+    std::string_view text = "a,b\n1,2";
+    CHECK_EQ(CsvReader::countRows(text), (std::size_t) 2);
+    CHECK_EQ(CsvReader::countRows("a,b\n1,2\n"), (std::size_t) 2);
+    CsvReader csv(text);
+    CHECK(csv.nextRow());
+    CHECK(csv.nextRow());
+    CHECK_EQ(csv.nextField(), "1");
+    CHECK_EQ(csv.nextField(), "2");
+    CHECK(!csv.nextRow());
+}
+
+/**
+ * @brief Numbers keep their integer part, and a field without a number is rejected
+ */
+static void testToInt() {
+    CHECK_EQ(CsvReader::toInt("2750"), 2750);
+    CHECK_EQ(CsvReader::toInt("52.00"), 52);
+    CHECK_EQ(CsvReader::toInt(" 7"), 7);
+    bool thrown = false;
+    try {
+        CsvReader::toInt("abc");
+    } catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    CHECK(thrown);
+}
+
+/**
+ * @brief Writes a file
+ * @param path
+ * @param contents
+ */
+static void writeFile(const std::filesystem::path &path, const std::string &contents) {
+    std::ofstream file(path, std::ios::binary);
+    file << contents;
+}
+
+/**
+ * @brief A dataset directory with CRLF endings, quoted populations and no trailing newlines loads completely
+ */
+static void testDatasetDirectory() {
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "project1-csvreader-test";
+    std::filesystem::create_directories(directory);
+    writeFile(directory / "Reservoir.csv", "Reservoir,Municipality,Id,Code,Maximum Delivery (m3/sec)\r\n"
+                                           "Ermida,Aveiro,1,R_1,2750");
+    writeFile(directory / "Stations.csv", "Id,Code\r\n1,PS_1\r\n");
+    writeFile(directory / "Cities.csv", "City,Id,Code,Demand,Population\r\n"
+                                        "Porto Moniz,1,C_1,18.00,\"2,517\"\r\n"
+                                        "Funchal,2,C_2,664.00,\"111,892\"");
+    writeFile(directory / "Pipes.csv", "Service_Point_A,Service_Point_B,Capacity,Direction\r\n"
+                                       "R_1,PS_1,1000,1\r\nPS_1,C_1,20,1\r\nPS_1,C_2,500,0");
+
+    Graph g;
+    Auxiliar::readDatasetDirectory(&g, directory.string());
+    CHECK_EQ(g.getReservoirSet().size(), (std::size_t) 1);
+    CHECK_EQ(g.getCitiesSet().size(), (std::size_t) 2);
+    CHECK_EQ(g.getServicePointSet().size(), (std::size_t) 4);
+    CHECK_EQ(g.getPipeSet().size(), (std::size_t) 4);
+    auto *reservoir = (Reservoir *) g.findServicePoint("R_1");
+    CHECK(reservoir != nullptr && reservoir->getMaxDelivery() == 2750);
+    auto *city = (City *) g.findServicePoint("C_2");
+    CHECK(city != nullptr && city->getDemand() == 664 && city->getPopulation() == 111892);
+    Pipe *pipe = g.getPipeByEnds("PS_1", "C_2");
+    CHECK(pipe != nullptr && pipe->getCapacity() == 500 && pipe->getReverse() != nullptr);
+    std::filesystem::remove_all(directory);
+}
+
+/**
+ * Unit test of CsvReader and of the dataset readers built on it
+ */
+int main() {
+    testQuotedField();
+    testCrlf();
+    testMissingTrailingNewline();
+    testToInt();
+    testDatasetDirectory();
+    return checkResult();
+}
@@ -0,0 +1,123 @@
+#include <string>
+#include <vector>
+#include "Check.h"
+#include "../src/Auxiliar.h"
+#include "../src/City.h"
+#include "../src/Management.h"
+
+static const FlowAlgorithm ALGORITHMS[] = {FlowAlgorithm::EDMONDS_KARP, FlowAlgorithm::DINIC,
+                                           FlowAlgorithm::PUSH_RELABEL};
+
+/**
+ * @brief Checks if two lists of affected Cities are the same
+ * @param a
+ * @param b
+ * @return true if they list the same Cities with the same flows, in the same order
+ */
+static bool sameCities(const std::vector<std::pair<std::string, flowDiff>> &a,
+                       const std::vector<std::pair<std::string, flowDiff>> &b) {
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].first != b[i].first || a[i].second.oldFlow != b[i].second.oldFlow
+            || a[i].second.newFlow != b[i].second.newFlow)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Checks if two lists of crucial Pipes are the same
+ * @param a
+ * @param b
+ * @return true if they list the same Pipes with the same flows, in the same order
+ */
+static bool samePipes(const std::vector<std::pair<Pipe *, flowDiff>> &a,
+                      const std::vector<std::pair<Pipe *, flowDiff>> &b) {
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].first != b[i].first || a[i].second.oldFlow != b[i].second.oldFlow
+            || a[i].second.newFlow != b[i].second.newFlow)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Checks if two contingency sweeps are the same
+ * @param a
+ * @param b
+ * @return true if they list the same failures affecting the same Cities, in the same order
+ */
+static bool sameContingencies(const std::vector<contingency> &a, const std::vector<contingency> &b) {
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].servicePoint != b[i].servicePoint || a[i].pipe != b[i].pipe
+            || !sameCities(a[i].citiesAffected, b[i].citiesAffected))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Every engine gives each City the Edmonds-Karp flow, before and after the failure of each Reservoir and
+ * Station, both when repairing the baseline flow and when solving again
+ * @param dataset
+ */
+static void testFlowPerCity(int dataset) {
+    Graph g;
+    Auxiliar::readDataset(&g, dataset);
+    CHECK(!g.getCitiesSet().empty());
+    Management reference(&g);
+    reference.setIncremental(false);
+    std::unordered_map<std::string,int> expected = reference.getMaxFlow();
+
+    for (FlowAlgorithm algorithm : ALGORITHMS) {
+        for (bool incremental : {true, false}) {
+            Management m(&g);
+            m.setAlgorithm(algorithm);
+            m.setIncremental(incremental);
+            CHECK(m.getMaxFlow() == expected);
+            for (ServicePoint *v : g.getServicePointSet()) {
+                if (dynamic_cast<City *>(v) == nullptr)
+                    CHECK(m.getMaxFlowAfterFailure(v, nullptr) == reference.getMaxFlowAfterFailure(v, nullptr));
+            }
+        }
+    }
+}
+
+/**
+ * @brief Every engine finds the Edmonds-Karp crucial Pipes of each City and contingencies, both when repairing the
+ * baseline flow and when solving again
+ */
+static void testFailureAnalyses() {
+    Graph g;
+    Auxiliar::readDataset(&g, 0);
+    Management reference(&g);
+    reference.setIncremental(false);
+    std::vector<contingency> expected = reference.getContingencies();
+    CHECK(!expected.empty());
+
+    for (FlowAlgorithm algorithm : ALGORITHMS) {
+        for (bool incremental : {true, false}) {
+            Management m(&g);
+            m.setAlgorithm(algorithm);
+            m.setIncremental(incremental);
+            CHECK(sameContingencies(m.getContingencies(), expected));
+            for (ServicePoint *city : g.getCitiesSet())
+                CHECK(samePipes(m.getCrucialPipesToCity(city), reference.getCrucialPipesToCity(city)));
+        }
+    }
+}
+
+/**
+ * Unit test of the max flow engines of Management against Edmonds-Karp on the bundled datasets
+ */
+int main() {
+    testFlowPerCity(0);
+    testFlowPerCity(1);
+    testFailureAnalyses();
+    return checkResult();
+}
@@ -0,0 +1,94 @@
+#include <random>
+#include <unordered_map>
+#include "Check.h"
+#include "../src/FlatHashMap.h"
+
+/**
+ * @brief Checks that a FlatHashMap holds exactly the entries of a reference map
+ * @param map
+ * @param reference
+ * @param keyRange keys to look up, from 0
+ */
+static void checkSame(const FlatHashMap<int> &map, const std::unordered_map<uint64_t,int> &reference, uint64_t keyRange) {
+    CHECK_EQ(map.size(), reference.size());
+    for (uint64_t k = 0; k < keyRange; k++) {
+        const int *value = map.find(k);
+        auto it = reference.find(k);
+        if (it == reference.end()) {
+            CHECK(value == nullptr);
+        } else {
+            CHECK(value != nullptr);
+            if (value != nullptr)
+                CHECK_EQ(*value, it->second);
+        }
+    }
+}
+
+/**
+ * @brief Erasing a key in the middle of a probe run keeps the keys after it reachable
+ */
+static void testEraseInsideRun() {
+    FlatHashMap<int> map;
+    for (int i = 0; i < 12; i++)
+        map.insert(FlatHashMap<int>::key(1, i), i);
+    for (int i = 0; i < 12; i += 3)
+        CHECK(map.erase(FlatHashMap<int>::key(1, i)));
+    for (int i = 0; i < 12; i++) {
+        const int *value = map.find(FlatHashMap<int>::key(1, i));
+        if (i % 3 == 0) {
+            CHECK(value == nullptr);
+        } else {
+            CHECK(value != nullptr);
+            if (value != nullptr)
+                CHECK_EQ(*value, i);
+        }
+    }
+    CHECK_EQ(map.size(), (std::size_t) 8);
+}
+
+/**
+ * @brief Erasing a missing key, or the same key twice, leaves the map as it was
+ */
+static void testEraseMissing() {
+    FlatHashMap<int> map;
+    CHECK(!map.erase(7));
+    map.insert(7, 70);
+    CHECK(map.erase(7));
+    CHECK(!map.erase(7));
+    CHECK_EQ(map.size(), (std::size_t) 0);
+    map.insert(7, 71);
+    CHECK(map.find(7) != nullptr && *map.find(7) == 71);
+}
+
+/**
+ * @brief Random inserts and erases in a small table, where probe runs are long and wrap around its end, agree with
+ * std::unordered_map
+ */
+static void testRandomAgainstReference() {
+    std::mt19937 rng(1);
+    FlatHashMap<int> map;
+    std::unordered_map<uint64_t,int> reference;
+    const uint64_t keyRange = 64;
+    for (int step = 0; step < 20000; step++) {
+        uint64_t k = rng() % keyRange;
+        if (rng() % 3 == 0) {
+            CHECK_EQ(map.erase(k), reference.erase(k) == 1);
+        } else {
+            map.insert(k, step);
+            reference[k] = step;
+        }
+        if (step % 500 == 0)
+            checkSame(map, reference, keyRange);
+    }
+    checkSame(map, reference, keyRange);
+}
+
+/**
+ * Unit test of FlatHashMap, focused on erasing by shifting entries back
+ */
+int main() {
+    testEraseInsideRun();
+    testEraseMissing();
+    testRandomAgainstReference();
+    return checkResult();
+}
@@ -0,0 +1,210 @@
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "Check.h"
+#include "../src/GraphTransaction.h"
+#include "../src/Auxiliar.h"
+#include "../src/City.h"
+#include "../src/Management.h"
+#include "../src/Reservoir.h"
+#include "../src/Station.h"
+
+/**
+ * @brief Builds a Reservoir, a Station and two Cities, one of them also fed straight from the Reservoir
+ * @param g empty Graph
+ */
+static void buildNetwork(Graph &g) {
+    g.addReservoir(new Reservoir("Ermida", "Aveiro", "1", "R_1", 20));
+    g.addStation(new Station("1", "PS_1"));
+    g.addCity(new City("Porto Moniz", "1", "C_1", 5, 2517));
+    g.addCity(new City("Funchal", "2", "C_2", 9, 111892));
+    g.addPipe("R_1", "PS_1", 10);
+    g.addPipe("PS_1", "C_1", 5);
+    g.addBidirectionalPipe("PS_1", "C_2", 7);
+    g.addPipe("R_1", "C_2", 3);
+}
+
+/**
+ * @brief Describes the sets, adjacency lists, capacities and operational flags of a Graph in their order
+ * @param g
+ * @return description of the Graph
+ */
+static std::string describe(const Graph &g) {
+    std::ostringstream out;
+    for (ServicePoint *v : g.getServicePointSet()) {
+        out << v->getCode() << (v->isOperational() ? "" : "!") << ":";
+        for (Pipe *e : v->getAdj())
+            out << " " << e->getDest()->getCode() << "/" << e->getCapacity() << (e->isOperational() ? "" : "!");
+        out << " <-";
+        for (Pipe *e : v->getIncoming())
+            out << " " << e->getOrig()->getCode();
+        out << "\n";
+    }
+    out << "pipes:";
+    for (Pipe *e : g.getPipeSet())
+        out << " " << e->getOrig()->getCode() << "-" << e->getDest()->getCode();
+    out << "\ncities: " << g.getCitiesSet().size() << " reservoirs: " << g.getReservoirSet().size();
+    return out.str();
+}
+
+/**
+ * @brief Rolling back undoes status, capacity and topology changes, and brings back the version
+ */
+static void testRollback() {
+    Graph g;
+    buildNetwork(g);
+    std::string before = describe(g);
+    unsigned long version = g.getVersion();
+    {
+        GraphTransaction transaction(&g);
+        g.setOperational(g.findServicePoint("PS_1"), false);
+        g.setOperational(g.getPipeByEnds("R_1", "C_2"), false);
+        g.setPipeCapacity(g.getPipeByEnds("PS_1", "C_1"), 1);
+        g.removePipe(g.getPipeByEnds("R_1", "PS_1"));
+        g.removeServicePoint(g.findServicePoint("C_1"));
+        g.addCity(new City("Santana", "3", "C_3", 4, 7000));
+        g.addPipe("R_1", "C_3", 4);
+        CHECK(g.getVersion() != version);
+        CHECK(describe(g) != before);
+        transaction.rollback();
+        CHECK(!transaction.isOpen());
+    }
+    CHECK_EQ(describe(g), before);
+    CHECK_EQ(g.getVersion(), version);
+    CHECK(g.findServicePoint("C_3") == nullptr);
+    CHECK(!g.inTransaction());
+
+    // A transaction that goes out of scope without a commit is rolled back
+    {
+        GraphTransaction transaction(&g);
+        g.removeServicePoint(g.findServicePoint("PS_1"));
+    }
+    CHECK_EQ(describe(g), before);
+    CHECK_EQ(g.getVersion(), version);
+}
+
+/**
+ * @brief Committed changes stay, and inside another transaction they are still undone with it
+ */
+static void testCommitAndNesting() {
+    Graph g;
+    buildNetwork(g);
+    std::string before = describe(g);
+    unsigned long version = g.getVersion();
+    {
+        GraphTransaction outer(&g);
+        g.setPipeCapacity(g.getPipeByEnds("R_1", "PS_1"), 8);
+        std::string middle = describe(g);
+        unsigned long middleVersion = g.getVersion();
+        {
+            GraphTransaction inner(&g);
+            g.setOperational(g.findServicePoint("C_2"), false);
+            inner.rollback();
+        }
+        CHECK_EQ(describe(g), middle);
+        CHECK_EQ(g.getVersion(), middleVersion);
+        {
+            GraphTransaction inner(&g);
+            g.removePipe(g.getPipeByEnds("PS_1", "C_1"));
+            inner.commit();
+        }
+        CHECK(g.getPipeByEnds("PS_1", "C_1") == nullptr);
+        CHECK(g.inTransaction());
+    }
+    CHECK_EQ(describe(g), before);
+    CHECK_EQ(g.getVersion(), version);
+
+    GraphTransaction transaction(&g);
+    g.setPipeCapacity(g.getPipeByEnds("R_1", "PS_1"), 8);
+    transaction.commit();
+    CHECK(!g.inTransaction());
+    CHECK_EQ(g.getPipeByEnds("R_1", "PS_1")->getCapacity(), 8.0);
+    bool thrown = false;
+    try {
+        transaction.rollback();
+    } catch (const std::logic_error &) {
+        thrown = true;
+    }
+    CHECK(thrown);
+}
+
+/**
+ * @brief Only the innermost transaction can be closed
+ */
+static void testInnermostOnly() {
+    Graph g;
+    buildNetwork(g);
+    std::size_t outer = g.beginTransaction();
+    g.setOperational(g.findServicePoint("C_1"), false);
+    std::size_t inner = g.beginTransaction();
+    bool thrown = false;
+    try {
+        g.rollbackTransaction(outer);
+    } catch (const std::logic_error &) {
+        thrown = true;
+    }
+    CHECK(thrown);
+    g.rollbackTransaction(inner);
+    g.rollbackTransaction(outer);
+    CHECK(g.findServicePoint("C_1")->isOperational());
+}
+
+/**
+ * @brief The touched ServicePoints and Pipes are listed once each, and a version is never given to two networks
+ */
+static void testTouchedAndVersions() {
+    Graph g;
+    buildNetwork(g);
+    unsigned long version = g.getVersion();
+    ServicePoint *station = g.findServicePoint("PS_1");
+    Pipe *pipe = g.getPipeByEnds("R_1", "C_2");
+    unsigned long changedVersion;
+    {
+        GraphTransaction transaction(&g);
+        CHECK_EQ(transaction.getEditCount(), (std::size_t) 0);
+        g.setOperational(station, false);
+        g.setOperational(station, true);
+        g.setPipeCapacity(pipe, 1);
+        CHECK_EQ(transaction.getEditCount(), (std::size_t) 3);
+        CHECK(transaction.getTouchedServicePoints() == std::vector<int>{station->getIndex()});
+        CHECK(transaction.getTouchedPipes() == std::vector<int>{pipe->getIndex()});
+        changedVersion = g.getVersion();
+    }
+    CHECK_EQ(g.getVersion(), version);
+
+    // A change after the rollback gets a version that no earlier network had
+    g.setPipeCapacity(pipe, 1);
+    CHECK(g.getVersion() != version);
+    CHECK(g.getVersion() > changedVersion);
+}
+
+/**
+ * @brief The failure analyses of Management, run as transactions, leave the Graph and its version as they were
+ */
+static void testManagementQueries() {
+    Graph g;
+    Auxiliar::readDataset(&g, 0);
+    std::string before = describe(g);
+    unsigned long version = g.getVersion();
+    Management m(&g);
+    m.getMaxFlow();
+    m.getMaxFlowAfterFailure(g.getServicePointSet()[0], nullptr);
+    m.getMaxFlowAfterFailure(nullptr, g.getPipeSet()[0]);
+    m.getCrucialPipesToCity(g.getCitiesSet()[0]);
+    m.getContingencies();
+    CHECK_EQ(g.getVersion(), version);
+    CHECK_EQ(describe(g), before);
+    CHECK(!g.inTransaction());
+}
+
+/**
+ * Unit test of GraphTransaction and of the transactions of Graph
+ */
+int main() {
+    testRollback();
+    testCommitAndNesting();
+    testInnermostOnly();
+    testTouchedAndVersions();
+    testManagementQueries();
+    return checkResult();
+}
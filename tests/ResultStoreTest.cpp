@@ -0,0 +1,135 @@
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include "Check.h"
+#include "../src/ResultStore.h"
+#include "../src/Auxiliar.h"
+#include "../src/Management.h"
+
+// Byte offset of the format version in the header of a results file
+static const size_t FORMAT_VERSION_OFFSET = 8;
+
+/**
+ * @brief Reads a whole file
+ * @param path
+ * @return contents of the file
+ */
+static std::string readFile(const std::filesystem::path &path) {
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+/**
+ * @brief Writes a file
+ * @param path
+ * @param contents
+ */
+static void writeFile(const std::filesystem::path &path, const std::string &contents) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << contents;
+}
+
+/**
+ * @brief A saved baseline loads into a new Management of the same network and gives the same answers
+ * @param path
+ */
+static void testRoundTrip(const std::filesystem::path &path) {
+    Graph g;
+    Auxiliar::readDataset(&g, 0);
+    Management computed(&g);
+    CHECK(computed.saveBaseline(path.string()));
+
+    Graph h;
+    Auxiliar::readDataset(&h, 0);
+    CHECK_EQ(ResultStore::hashNetwork(&h, 0), ResultStore::hashNetwork(&g, 0));
+    Management loaded(&h);
+    CHECK(loaded.loadBaseline(path.string()));
+    CHECK(loaded.getMaxFlow() == computed.getMaxFlow());
+
+    Pipe *a = g.getPipeSet()[0];
+    Pipe *b = h.getPipeByEnds(a->getOrig()->getCode(), a->getDest()->getCode());
+    CHECK(b != nullptr);
+    if (b != nullptr)
+        CHECK(loaded.getMaxFlowAfterFailure(nullptr, b) == computed.getMaxFlowAfterFailure(nullptr, a));
+}
+
+/**
+ * @brief A baseline of another algorithm or of a changed network is not loaded
+ * @param path a saved Edmonds-Karp baseline of the small dataset
+ */
+static void testOtherNetwork(const std::filesystem::path &path) {
+    Graph g;
+    Auxiliar::readDataset(&g, 0);
+    CHECK(ResultStore::hashNetwork(&g, 0) != ResultStore::hashNetwork(&g, 1));
+
+    Management dinic(&g);
+    dinic.setAlgorithm(FlowAlgorithm::DINIC);
+    CHECK(!dinic.loadBaseline(path.string()));
+
+    Pipe *pipe = g.getPipeSet()[0];
+    g.setPipeCapacity(pipe, (int) pipe->getCapacity() + 1);
+    Management changed(&g);
+    CHECK(!changed.loadBaseline(path.string()));
+
+    Graph h;
+    Auxiliar::readDataset(&h, 0);
+    h.setOperational(h.getPipeSet()[0], false);
+    Management failed(&h);
+    CHECK(!failed.loadBaseline(path.string()));
+}
+
+/**
+ * @brief Missing, truncated and damaged files are not loaded, and the baseline is computed instead
+ * @param path a saved Edmonds-Karp baseline of the small dataset
+ */
+static void testCorruptFiles(const std::filesystem::path &path) {
+    std::string contents = readFile(path);
+    std::filesystem::path damaged = path;
+    damaged += ".damaged";
+    Graph g;
+    Auxiliar::readDataset(&g, 0);
+    Management m(&g);
+
+    CHECK(!m.loadBaseline(path.string() + ".missing"));
+
+    writeFile(damaged, contents.substr(0, 10));
+    CHECK(!m.loadBaseline(damaged.string()));
+    writeFile(damaged, contents.substr(0, contents.size() - 1));
+    CHECK(!m.loadBaseline(damaged.string()));
+    writeFile(damaged, contents + std::string(8, '\0'));
+    CHECK(!m.loadBaseline(damaged.string()));
+
+    std::string badMagic = contents;
+    badMagic[0] ^= 0x20;
+    writeFile(damaged, badMagic);
+    CHECK(!m.loadBaseline(damaged.string()));
+
+    std::string badVersion = contents;
+    uint32_t version = ResultStore::FORMAT_VERSION - 1;
+    std::memcpy(&badVersion[FORMAT_VERSION_OFFSET], &version, sizeof(version));
+    writeFile(damaged, badVersion);
+    CHECK(!m.loadBaseline(damaged.string()));
+
+    Graph h;
+    Auxiliar::readDataset(&h, 0);
+    Management computed(&h);
+    CHECK(m.getMaxFlow() == computed.getMaxFlow());
+    std::filesystem::remove(damaged);
+}
+
+/**
+ * Unit test of ResultStore and of the baseline files of Management
+ */
+int main() {
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "project1-resultstore-test";
+    std::filesystem::create_directories(directory);
+    std::filesystem::path path = directory / "baseline.results";
+    testRoundTrip(path);
+    testOtherNetwork(path);
+    testCorruptFiles(path);
+    std::filesystem::remove_all(directory);
+    return checkResult();
+}
@@ -0,0 +1,125 @@
+#include <string>
+#include "Check.h"
+#include "../src/ScenarioCache.h"
+#include "../src/Auxiliar.h"
+#include "../src/Management.h"
+
+/**
+ * @brief Builds a flow per City with a single City
+ * @param flow
+ * @return flow per City
+ */
+static ScenarioCache::FlowPerCity flowOf(int flow) {
+    return {{"C_1", flow}};
+}
+
+/**
+ * @brief Lookups count hits and misses, and the elements of different kinds give different scenarios
+ */
+static void testHitsAndMisses() {
+    ScenarioCache cache(4);
+    ScenarioCache::Scenario servicePoint = {ScenarioCache::servicePointKey(3)};
+    ScenarioCache::Scenario pipe = {ScenarioCache::pipeKey(3)};
+    CHECK(ScenarioCache::servicePointKey(3) != ScenarioCache::pipeKey(3));
+
+    CHECK(cache.find(1, servicePoint) == nullptr);
+    cache.insert(1, servicePoint, flowOf(10));
+    const ScenarioCache::FlowPerCity *found = cache.find(1, servicePoint);
+    CHECK(found != nullptr && found->at("C_1") == 10);
+    CHECK(cache.find(1, pipe) == nullptr);
+    CHECK_EQ(cache.getHits(), 1UL);
+    CHECK_EQ(cache.getMisses(), 2UL);
+
+    cache.insert(1, servicePoint, flowOf(20));
+    found = cache.find(1, servicePoint);
+    CHECK(found != nullptr && found->at("C_1") == 20);
+    CHECK_EQ(cache.size(), (std::size_t) 1);
+}
+
+/**
+ * @brief The least recently used entry is evicted first, and a lookup makes an entry the most recently used
+ */
+static void testEviction() {
+    ScenarioCache cache(2);
+    ScenarioCache::Scenario a = {ScenarioCache::pipeKey(1)};
+    ScenarioCache::Scenario b = {ScenarioCache::pipeKey(2)};
+    ScenarioCache::Scenario c = {ScenarioCache::pipeKey(1), ScenarioCache::pipeKey(2)};
+    cache.insert(1, a, flowOf(1));
+    cache.insert(1, b, flowOf(2));
+    CHECK(cache.find(1, a) != nullptr);
+    cache.insert(1, c, flowOf(3));
+    CHECK_EQ(cache.size(), (std::size_t) 2);
+    CHECK_EQ(cache.getEvictions(), 1UL);
+    CHECK(cache.find(1, b) == nullptr);
+    CHECK(cache.find(1, a) != nullptr);
+    CHECK(cache.find(1, c) != nullptr);
+
+    cache.setCapacity(1);
+    CHECK_EQ(cache.size(), (std::size_t) 1);
+    CHECK_EQ(cache.getEvictions(), 2UL);
+    CHECK(cache.find(1, c) != nullptr);
+
+    cache.setCapacity(0);
+    CHECK_EQ(cache.size(), (std::size_t) 0);
+    cache.insert(1, a, flowOf(1));
+    CHECK_EQ(cache.size(), (std::size_t) 0);
+    CHECK(cache.find(1, a) == nullptr);
+}
+
+/**
+ * @brief A lookup or insertion with another Graph version drops every entry
+ */
+static void testInvalidation() {
+    ScenarioCache cache;
+    ScenarioCache::Scenario a = {ScenarioCache::servicePointKey(1)};
+    ScenarioCache::Scenario b = {ScenarioCache::servicePointKey(2)};
+    cache.insert(1, a, flowOf(1));
+    cache.insert(1, b, flowOf(2));
+    CHECK(cache.find(2, a) == nullptr);
+    CHECK_EQ(cache.size(), (std::size_t) 0);
+    CHECK_EQ(cache.getInvalidations(), 2UL);
+
+    cache.insert(2, a, flowOf(3));
+    cache.insert(3, b, flowOf(4));
+    CHECK_EQ(cache.size(), (std::size_t) 1);
+    CHECK_EQ(cache.getInvalidations(), 3UL);
+    CHECK(cache.find(3, a) == nullptr);
+    CHECK(cache.find(3, b) != nullptr);
+}
+
+/**
+ * @brief Management answers a repeated failure from the cache, and answers it again after the network changes
+ */
+static void testManagement() {
+    Graph g;
+    Auxiliar::readDataset(&g, 0);
+    Management m(&g);
+    Pipe *pipe = g.getPipeSet()[0];
+    std::unordered_map<std::string,int> first = m.getMaxFlowAfterFailure(nullptr, pipe);
+    unsigned long hits = m.getScenarioCache().getHits();
+    CHECK(m.getMaxFlowAfterFailure(nullptr, pipe) == first);
+    CHECK_EQ(m.getScenarioCache().getHits(), hits + 1);
+
+    Pipe *other = g.getPipeSet()[1];
+    g.setPipeCapacity(other, 0);
+    std::unordered_map<std::string,int> changed = m.getMaxFlowAfterFailure(nullptr, pipe);
+    CHECK_EQ(m.getScenarioCache().getHits(), hits + 1);
+    CHECK(m.getScenarioCache().getInvalidations() > 0);
+
+    Graph h;
+    Auxiliar::readDataset(&h, 0);
+    h.setPipeCapacity(h.getPipeSet()[1], 0);
+    Management fresh(&h);
+    CHECK(changed == fresh.getMaxFlowAfterFailure(nullptr, h.getPipeSet()[0]));
+}
+
+/**
+ * Unit test of ScenarioCache
+ */
+int main() {
+    testHitsAndMisses();
+    testEviction();
+    testInvalidation();
+    testManagement();
+    return checkResult();
+}
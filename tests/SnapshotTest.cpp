@@ -0,0 +1,176 @@
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include "Check.h"
+#include "../src/Snapshot.h"
+#include "../src/Auxiliar.h"
+#include "../src/City.h"
+#include "../src/Management.h"
+#include "../src/Reservoir.h"
+
+// Byte offsets of the header fields and record sizes of the snapshot format, to damage a saved file
+static const size_t FORMAT_VERSION_OFFSET = 8;
+static const size_t SERVICE_POINTS_OFFSET_OFFSET = 32;
+static const size_t ARCS_OFFSET_OFFSET = 56;
+static const size_t FILE_SIZE_OFFSET = 64;
+static const size_t SERVICE_POINT_RECORD_SIZE = 44;
+static const size_t CODE_REF_OFFSET = 4;
+
+/**
+ * @brief Reads a whole file
+ * @param path
+ * @return contents of the file
+ */
+static std::string readFile(const std::filesystem::path &path) {
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+/**
+ * @brief Writes a file
+ * @param path
+ * @param contents
+ */
+static void writeFile(const std::filesystem::path &path, const std::string &contents) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << contents;
+}
+
+/**
+ * @brief Reads a 64 bit header field
+ * @param contents
+ * @param offset
+ * @return value of the field
+ */
+static uint64_t readField(const std::string &contents, size_t offset) {
+    uint64_t value;
+    std::memcpy(&value, contents.data() + offset, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Checks that a damaged file is rejected and leaves the Graph empty
+ * @param path
+ * @param contents damaged contents, written to path
+ */
+static void checkRejected(const std::filesystem::path &path, const std::string &contents) {
+    writeFile(path, contents);
+    Graph g;
+    CHECK(!Snapshot::load(&g, path.string()));
+    CHECK_EQ(g.getServicePointSet().size(), (std::size_t) 0);
+    CHECK_EQ(g.getPipeSet().size(), (std::size_t) 0);
+}
+
+/**
+ * @brief The small dataset saved and loaded again has the same ServicePoints, the same Pipes in the same order and
+ * the same maximum flow
+ * @param path
+ */
+static void testRoundTrip(const std::filesystem::path &path) {
+    Graph original;
+    Auxiliar::readDataset(&original, 0);
+    CHECK(Snapshot::save(&original, path.string()));
+    Graph loaded;
+    CHECK(Snapshot::load(&loaded, path.string()));
+
+    CHECK_EQ(loaded.getServicePointSet().size(), original.getServicePointSet().size());
+    CHECK_EQ(loaded.getReservoirSet().size(), original.getReservoirSet().size());
+    CHECK_EQ(loaded.getCitiesSet().size(), original.getCitiesSet().size());
+    for (size_t i = 0; i < original.getServicePointSet().size() && i < loaded.getServicePointSet().size(); i++) {
+        ServicePoint *a = original.getServicePointSet()[i];
+        ServicePoint *b = loaded.getServicePointSet()[i];
+        CHECK_EQ(b->getCode(), a->getCode());
+        if (auto *r = dynamic_cast<Reservoir *>(a)) {
+            auto *s = dynamic_cast<Reservoir *>(b);
+            CHECK(s != nullptr && s->getName() == r->getName() && s->getMunicipality() == r->getMunicipality()
+                  && s->getId() == r->getId() && s->getMaxDelivery() == r->getMaxDelivery());
+        } else if (auto *c = dynamic_cast<City *>(a)) {
+            auto *d = dynamic_cast<City *>(b);
+            CHECK(d != nullptr && d->getName() == c->getName() && d->getId() == c->getId()
+                  && d->getDemand() == c->getDemand() && d->getPopulation() == c->getPopulation());
+        }
+    }
+    CHECK_EQ(loaded.getPipeSet().size(), original.getPipeSet().size());
+    for (size_t i = 0; i < original.getPipeSet().size() && i < loaded.getPipeSet().size(); i++) {
+        Pipe *a = original.getPipeSet()[i];
+        Pipe *b = loaded.getPipeSet()[i];
+        CHECK_EQ(b->getOrig()->getCode(), a->getOrig()->getCode());
+        CHECK_EQ(b->getDest()->getCode(), a->getDest()->getCode());
+        CHECK_EQ(b->getCapacity(), a->getCapacity());
+        CHECK_EQ(b->getReverse() != nullptr, a->getReverse() != nullptr);
+    }
+
+    Management fromCsv(&original);
+    Management fromSnapshot(&loaded);
+    CHECK(fromSnapshot.getMaxFlow() == fromCsv.getMaxFlow());
+}
+
+/**
+ * @brief Missing, truncated and damaged files are rejected without touching the Graph
+ * @param path a saved snapshot of the small dataset
+ */
+static void testCorruptFiles(const std::filesystem::path &path) {
+    std::string contents = readFile(path);
+    std::filesystem::path damaged = path;
+    damaged += ".damaged";
+
+    Graph g;
+    CHECK(!Snapshot::load(&g, (path.string() + ".missing")));
+    CHECK_EQ(g.getServicePointSet().size(), (std::size_t) 0);
+
+    checkRejected(damaged, "");
+    checkRejected(damaged, contents.substr(0, 40));
+    checkRejected(damaged, contents.substr(0, contents.size() - 1));
+
+    std::string badMagic = contents;
+    badMagic[0] ^= 0x20;
+    checkRejected(damaged, badMagic);
+
+    std::string badVersion = contents;
+    uint32_t version = Snapshot::FORMAT_VERSION + 1;
+    std::memcpy(&badVersion[FORMAT_VERSION_OFFSET], &version, sizeof(version));
+    checkRejected(damaged, badVersion);
+
+    std::string badFileSize = contents;
+    uint64_t fileSize = contents.size() + 8;
+    std::memcpy(&badFileSize[FILE_SIZE_OFFSET], &fileSize, sizeof(fileSize));
+    checkRejected(damaged, badFileSize + std::string(7, '\0'));
+
+    // The first arc points past the ServicePoint table
+    std::string badArc = contents;
+    uint32_t dest = 0xffffffff;
+    std::memcpy(&badArc[readField(contents, ARCS_OFFSET_OFFSET)], &dest, sizeof(dest));
+    checkRejected(damaged, badArc);
+
+    // The second ServicePoint has the code of the first one
+    std::string duplicateCode = contents;
+    size_t records = readField(contents, SERVICE_POINTS_OFFSET_OFFSET);
+    std::memcpy(&duplicateCode[records + SERVICE_POINT_RECORD_SIZE + CODE_REF_OFFSET],
+                &contents[records + CODE_REF_OFFSET], 8);
+    checkRejected(damaged, duplicateCode);
+
+    // Loading on top of a Graph that already has the same codes is rejected as well
+    Graph full;
+    Auxiliar::readDataset(&full, 0);
+    size_t servicePoints = full.getServicePointSet().size();
+    CHECK(!Snapshot::load(&full, path.string()));
+    CHECK_EQ(full.getServicePointSet().size(), servicePoints);
+
+    std::filesystem::remove(damaged);
+}
+
+/**
+ * Unit test of Snapshot
+ */
+int main() {
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "project1-snapshot-test";
+    std::filesystem::create_directories(directory);
+    std::filesystem::path path = directory / "network.snap";
+    testRoundTrip(path);
+    testCorruptFiles(path);
+    std::filesystem::remove_all(directory);
+    return checkResult();
+}
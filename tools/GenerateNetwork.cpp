@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include "../src/NetworkGenerator.h"
+
+/**
+ * @brief Parses the name of a topology
+ * @param name random, tree, grid or mixed
+ * @return topology
+ * @details Throws a logic_error if the name is not known
+ */
+static NetworkTopology parseTopology(const std::string &name) {
+    if (name == "random")
+        return NetworkTopology::RANDOM;
+    if (name == "tree")
+        return NetworkTopology::TREE;
+    if (name == "grid")
+        return NetworkTopology::GRID;
+    if (name == "mixed")
+        return NetworkTopology::MIXED;
+    throw std::logic_error("unknown topology " + name);
+}
+
+/**
+ * @brief Prints the options of the generator
+ * @param out
+ */
+static void printUsage(std::ostream &out) {
+    out << "Usage: Project1Generate [options]\n"
+        << "  --pipes <n>           Pipe rows (default 100000)\n"
+        << "  --topology <name>     random, tree, grid or mixed (default mixed)\n"
+        << "  --bidirectional <x>   share of the Station to Station rows that are bidirectional, from 0 to 1 (default 0.2)\n"
+        << "  --seed <n>            seed, the same options always give the same files (default 1)\n"
+        << "  --output <dir>        directory of the files, created if missing (default the current one)\n"
+        << "  --reservoirs <n>, --stations <n>, --cities <n>\n"
+        << "                        sizes, which otherwise follow from the Pipe rows and the topology\n"
+        << "  --help                print this message\n";
+}
+
+/**
+ * Writes a synthetic network as Reservoir.csv, Stations.csv, Cities.csv and Pipes.csv, in the format of the large
+ * dataset, to be read with "Project1 --dataset-dir <dir>" or put in place of data/Project1LargeDataSet.
+ *
+ * Options:
+ *  --pipes <n>           Pipe rows (default 100000)
+ *  --topology <name>     random, tree, grid or mixed (default mixed)
+ *  --bidirectional <x>   share of the Station to Station rows that are bidirectional, from 0 to 1 (default 0.2)
+ *  --seed <n>            seed, the same options always give the same files (default 1)
+ *  --output <dir>        directory of the files, created if missing (default the current one)
+ *  --reservoirs <n>, --stations <n>, --cities <n>
+ *                        sizes, which otherwise follow from the Pipe rows and the topology
+ *
+ * An unknown option or an option without its value prints the usage and exits with 1.
+ */
+int main(int argc, char *argv[]) {
+    GeneratorOptions options;
+    options.pipes = 100000;
+    options.topology = NetworkTopology::MIXED;
+    std::string output = ".";
+    int reservoirs = 0, stations = 0, cities = 0;
+    try {
+        for (int i = 1; i < argc; i++) {
+            // Takes the value that follows the option
+            auto value = [&]() {
+                if (i + 1 == argc)
+                    throw std::logic_error(std::string("missing value of ") + argv[i]);
+                return argv[++i];
+            };
+            if (std::strcmp(argv[i], "--help") == 0) {
+                printUsage(std::cout);
+                return 0;
+            } else if (std::strcmp(argv[i], "--pipes") == 0)
+                options.pipes = std::max(1L, std::atol(value()));
+            else if (std::strcmp(argv[i], "--topology") == 0)
+                options.topology = parseTopology(value());
+            else if (std::strcmp(argv[i], "--bidirectional") == 0)
+                options.bidirectionalShare = std::min(1.0, std::max(0.0, std::atof(value())));
+            else if (std::strcmp(argv[i], "--seed") == 0)
+                options.seed = (uint32_t) std::atol(value());
+            else if (std::strcmp(argv[i], "--output") == 0)
+                output = value();
+            else if (std::strcmp(argv[i], "--reservoirs") == 0)
+                reservoirs = std::atoi(value());
+            else if (std::strcmp(argv[i], "--stations") == 0)
+                stations = std::atoi(value());
+            else if (std::strcmp(argv[i], "--cities") == 0)
+                cities = std::atoi(value());
+            else
+                throw std::logic_error(std::string("unknown option ") + argv[i]);
+        }
+    } catch (const std::logic_error &e) {
+        std::cerr << e.what() << "\n";
+        printUsage(std::cerr);
+        return 1;
+    }
+
+    try {
+        // Trunks and grids need a feeding row per Station, so they have more Stations per Pipe than random links
+        long pipes = options.pipes;
+        switch (options.topology) {
+            case NetworkTopology::TREE:
+                options.stations = (int) std::max(1L, pipes * 6 / 10);
+                options.cities = (int) std::max(1L, pipes / 4);
+                options.reservoirs = (int) std::max(1L, pipes / 1000);
+                break;
+            case NetworkTopology::GRID:
+                options.stations = (int) std::max(1L, pipes * 45 / 100);
+                options.cities = (int) std::max(1L, pipes * 15 / 100);
+                options.reservoirs = (int) std::max(1L, pipes / 2000);
+                break;
+            case NetworkTopology::MIXED:
+                options.stations = (int) std::max(1L, pipes / 2);
+                options.cities = (int) std::max(1L, pipes / 5);
+                options.reservoirs = (int) std::max(1L, pipes / 1000);
+                break;
+            default:
+                options.stations = (int) std::max(1L, pipes / 5);
+                options.cities = (int) std::max(1L, pipes / 25);
+                options.reservoirs = (int) std::max(1L, pipes / 200);
+        }
+        if (reservoirs > 0)
+            options.reservoirs = reservoirs;
+        if (stations > 0)
+            options.stations = stations;
+        if (cities > 0)
+            options.cities = cities;
+        options.pipes = std::max(options.pipes, (long) options.stations + options.cities);
+
+        NetworkGenerator generator(options);
+        std::error_code error;
+        std::filesystem::create_directories(output, error);
+        if (!generator.writeCsv(output)) {
+            std::cerr << "Could not write the files to " << output << "\n";
+            return 1;
+        }
+        std::cerr << "Wrote " << options.reservoirs << " Reservoirs, " << options.stations << " Stations, "
+                  << options.cities << " Cities and " << generator.getPipes().size() << " Pipe rows to " << output
+                  << "\n";
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}